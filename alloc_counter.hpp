@@ -0,0 +1,69 @@
+#ifndef ALLOC_COUNTER_HPP
+#define ALLOC_COUNTER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+/*
+ * Counts the heap allocations of the whole program by replacing the global operator new and delete,
+ * include it in one translation unit of a benchmark only.
+ * All replaceable forms are replaced so that every new is paired with a delete of this file.
+ * None of them is inlined, otherwise gcc sees a pointer from malloc reach operator delete (or the
+ * other way round) and warns about mismatched allocation functions.
+ */
+namespace dacin{ namespace lp{
+
+    std::atomic<uint64_t>& allocation_count(){
+        static std::atomic<uint64_t> count{0};
+        return count;
+    }
+
+    namespace detail{
+        void* counted_alloc(size_t size, size_t align = 0) noexcept {
+            allocation_count().fetch_add(1, std::memory_order_relaxed);
+            if(size == 0) size = 1;
+            if(align <= alignof(std::max_align_t)) return std::malloc(size);
+            #ifdef __cpp_aligned_new
+            // aligned_alloc needs a multiple of the alignment
+            return std::aligned_alloc(align, (size + align - 1) / align * align);
+            #else
+            return nullptr;
+            #endif
+        }
+        void* counted_alloc_or_throw(size_t size, size_t align = 0){
+            if(void *ptr = counted_alloc(size, align)) return ptr;
+            throw std::bad_alloc();
+        }
+    }
+
+} }
+
+#define DACIN_LP_NOINLINE __attribute__((noinline))
+DACIN_LP_NOINLINE void* operator new(size_t size){ return dacin::lp::detail::counted_alloc_or_throw(size); }
+DACIN_LP_NOINLINE void* operator new[](size_t size){ return dacin::lp::detail::counted_alloc_or_throw(size); }
+DACIN_LP_NOINLINE void* operator new(size_t size, std::nothrow_t const&) noexcept { return dacin::lp::detail::counted_alloc(size); }
+DACIN_LP_NOINLINE void* operator new[](size_t size, std::nothrow_t const&) noexcept { return dacin::lp::detail::counted_alloc(size); }
+DACIN_LP_NOINLINE void operator delete(void *ptr) noexcept { std::free(ptr); }
+DACIN_LP_NOINLINE void operator delete[](void *ptr) noexcept { std::free(ptr); }
+DACIN_LP_NOINLINE void operator delete(void *ptr, size_t) noexcept { std::free(ptr); }
+DACIN_LP_NOINLINE void operator delete[](void *ptr, size_t) noexcept { std::free(ptr); }
+DACIN_LP_NOINLINE void operator delete(void *ptr, std::nothrow_t const&) noexcept { std::free(ptr); }
+DACIN_LP_NOINLINE void operator delete[](void *ptr, std::nothrow_t const&) noexcept { std::free(ptr); }
+#ifdef __cpp_aligned_new
+DACIN_LP_NOINLINE void* operator new(size_t size, std::align_val_t align){ return dacin::lp::detail::counted_alloc_or_throw(size, size_t(align)); }
+DACIN_LP_NOINLINE void* operator new[](size_t size, std::align_val_t align){ return dacin::lp::detail::counted_alloc_or_throw(size, size_t(align)); }
+DACIN_LP_NOINLINE void* operator new(size_t size, std::align_val_t align, std::nothrow_t const&) noexcept { return dacin::lp::detail::counted_alloc(size, size_t(align)); }
+DACIN_LP_NOINLINE void* operator new[](size_t size, std::align_val_t align, std::nothrow_t const&) noexcept { return dacin::lp::detail::counted_alloc(size, size_t(align)); }
+DACIN_LP_NOINLINE void operator delete(void *ptr, std::align_val_t) noexcept { std::free(ptr); }
+DACIN_LP_NOINLINE void operator delete[](void *ptr, std::align_val_t) noexcept { std::free(ptr); }
+DACIN_LP_NOINLINE void operator delete(void *ptr, size_t, std::align_val_t) noexcept { std::free(ptr); }
+DACIN_LP_NOINLINE void operator delete[](void *ptr, size_t, std::align_val_t) noexcept { std::free(ptr); }
+DACIN_LP_NOINLINE void operator delete(void *ptr, std::align_val_t, std::nothrow_t const&) noexcept { std::free(ptr); }
+DACIN_LP_NOINLINE void operator delete[](void *ptr, std::align_val_t, std::nothrow_t const&) noexcept { std::free(ptr); }
+#endif // __cpp_aligned_new
+#undef DACIN_LP_NOINLINE
+
+#endif // ALLOC_COUNTER_HPP
@@ -0,0 +1,121 @@
+#ifndef BATCH_HPP
+#define BATCH_HPP
+
+#include <atomic>
+#include <thread>
+
+#include "clarkson.hpp"
+#include "lp_instance.hpp"
+#include "lp_result.hpp"
+#include "num.hpp"
+#include "presolve.hpp"
+#include "seidel.hpp"
+#include "solve_context.hpp"
+#include "util.hpp"
+
+namespace dacin{ namespace lp{
+
+    namespace detail{
+        // solves objectives[begin, end) in order, passing the tight constraints of
+        // each solution on as sample hint for the next objective
+        void clarkson_batch_range(vector<vector<Num> > const&A, vector<vector<Num> > const&objectives, Backend backend, vector<Lp_Result> &results, int begin, int end){
+            const int max_hint = 2*(A.empty() ? 0 : A[0].size());
+            vector<int> hint, tight;
+            for(int i=begin;i<end;++i){
+                solve_check();
+                results[i] = clarkson_2(A, objectives[i], backend, hint, &tight);
+                if(!results[i].is_feasible()){
+                    // all objectives share the constraints
+                    for(int j=i+1;j<end;++j) results[j] = results[i];
+                    return;
+                }
+                hint = move(tight);
+                if((int)hint.size() > max_hint) hint.resize(max_hint);
+            }
+        }
+    }
+
+    /*
+     * Solves the lp given by the constraints of lp once for every objective.
+     * The constraints are presolved once and shared by all solves,
+     * consecutive objectives are warm started with the previous basis.
+     * The certificates of the results refer to the rows of lp.
+     * Objectives are split into num_threads contiguous blocks that are solved in parallel,
+     * so objectives should be ordered such that neighbours have similar optima.
+     * All blocks stop with context (by default the context of the calling thread, see solve_with_context),
+     * the objectives they didn't solve get the status CANCELLED.
+     */
+    vector<Lp_Result> solve_clarkson_batch(Lp_Instance const&lp, vector<vector<Num> > const&objectives, Backend backend, int num_threads = 1, Solve_Context *context = detail::current_context()){
+        const int m = objectives.size();
+        for(auto const&e:objectives) assert((int)e.size() == lp.d());
+        Presolved_Lp pre = presolve(lp);
+        vector<vector<Num> > const&A = pre.get_lp().get_A();
+        vector<Lp_Result> results(m, Lp_Result(Lp_Status::CANCELLED, {}, {}, Fraction()));
+        num_threads = std::max(1, std::min(num_threads, m));
+        const size_t stall_limit = simplex_stall_limit();
+        auto block = [&](int t){
+            const int begin = (int64_t)m*t/num_threads, end = (int64_t)m*(t+1)/num_threads;
+            simplex_stall_limit() = stall_limit;
+            detail::run_worker(context, t, [&]{ detail::clarkson_batch_range(A, objectives, backend, results, begin, end); });
+        };
+        if(num_threads == 1){
+            block(0);
+        } else {
+            vector<std::thread> threads;
+            for(int t=0;t<num_threads;++t){
+                threads.emplace_back(block, t);
+            }
+            for(auto &e:threads){
+                e.join();
+            }
+        }
+        if(context) context->check_deadline();
+        for(auto &e:results){
+            e = pre.map_result(move(e));
+        }
+        return results;
+    }
+
+    /*
+     * Solves independent lps on num_threads threads, e.g. solve_parallel(lps, solve_clarkson_seidel<Num>, 8).
+     * lps[i] is solved under a context with seed seed + i, so the results don't depend
+     * on num_threads or on which thread picks up which lp.
+     * These contexts have context as parent (by default the context of the calling thread), lps that
+     * are not solved once it is cancelled get the status CANCELLED.
+     */
+    template<typename Solve>
+    vector<Lp_Result> solve_parallel(vector<Lp_Instance> const&lps, Solve solve, int num_threads = 1, uint64_t seed = 0, Solve_Context *context = detail::current_context()){
+        const int m = lps.size();
+        vector<Lp_Result> results(m);
+        std::atomic<int> next(0);
+        const size_t stall_limit = simplex_stall_limit();
+        auto work = [&](){
+            simplex_stall_limit() = stall_limit;
+            for(int i;(i = next++) < m;){
+                Solve_Context lp_context;
+                if(context) lp_context.set_parent(*context);
+                lp_context.set_seed(seed + i);
+                if(lp_context.is_cancelled()) results[i] = Lp_Result(Lp_Status::CANCELLED, {}, {}, Fraction());
+                else results[i] = solve_with_context(lp_context, lps[i], solve);
+            }
+        };
+        num_threads = std::max(1, std::min(num_threads, m));
+        vector<std::thread> threads;
+        for(int t=1;t<num_threads;++t){
+            threads.emplace_back(work);
+        }
+        work();
+        for(auto &e:threads){
+            e.join();
+        }
+        if(context) context->check_deadline();
+        return results;
+    }
+
+    template<bool move_to_front = false>
+    vector<Lp_Result> solve_clarkson_seidel_batch(Lp_Instance const&lp, vector<vector<Num> > const&objectives, int num_threads = 1){
+        return solve_clarkson_batch(lp, objectives, solve_seidel<move_to_front>, num_threads);
+    }
+
+} }
+#endif // BATCH_HPP
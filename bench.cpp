@@ -0,0 +1,155 @@
+// benchmark suite, run with --help for the options
+#include "alloc_counter.hpp"
+#include "clarkson.hpp"
+#include "generators.hpp"
+#include "portfolio.hpp"
+#include "seidel.hpp"
+#include "simplex.hpp"
+
+#include <bits/stdc++.h>
+
+using namespace std;
+using namespace dacin::lp;
+
+struct Bench_Solver{
+    string name;
+    Backend solve;
+    // largest number of constraints this solver is run on, for d <= 4 and for larger d
+    int max_n, max_n_high_d;
+};
+
+struct Bench_Result{
+    string name;
+    double median, p95;
+    uint64_t allocations;
+    size_t bits;
+    Lp_Status status;
+    Fraction objective;
+};
+
+string objective_string(Bench_Result const&r){
+    if(r.status == Lp_Status::INFEASIBLE) return "infeasible";
+    if(r.status == Lp_Status::UNBOUNDED) return "unbounded";
+    Num a = r.objective.numerator(), b = r.objective.denominator();
+    const Num g = Num::gcd(Num::abs(a), b);
+    ostringstream o;
+    o << a / g << "/" << b / g;
+    return o.str();
+}
+
+// largest bitlength of the solution vectors, as a measure of coefficient growth
+size_t result_bits(Lp_Result const&res){
+    size_t ret = 0;
+    for(auto const*v : {&res.get_x(), &res.get_ray(), &res.get_dual(), &res.get_farkas()}){
+        for(auto const&e:*v) ret = max(ret, e.bitlength());
+    }
+    return ret;
+}
+
+Bench_Result run_case(string const&name, Lp_Instance const&lp, Backend solve, int repetitions, uint64_t seed){
+    vector<double> times;
+    uint64_t allocs = 0;
+    Lp_Result res;
+    for(int it=0;it<repetitions;++it){
+        rng.seed(seed + it);
+        const uint64_t before = allocation_count().load();
+        const auto start = chrono::steady_clock::now();
+        res = solve(lp);
+        times.push_back(chrono::duration<double>(chrono::steady_clock::now() - start).count());
+        allocs += allocation_count().load() - before;
+    }
+    sort(times.begin(), times.end());
+    return Bench_Result{name, times[times.size()/2], times[(size_t)ceil(0.95*times.size())-1], allocs / repetitions, result_bits(res), res.get_status(), res.get_objective()};
+}
+
+// reads the medians of a previous run, keyed by case name
+map<string, double> read_baseline(string const&filename){
+    ifstream in(filename);
+    if(!in) throw runtime_error("cannot open " + filename);
+    map<string, double> ret;
+    string line;
+    getline(in, line);
+    while(getline(in, line)){
+        istringstream ss(line);
+        string name;
+        double median;
+        if(ss >> name >> median) ret[name] = median;
+    }
+    return ret;
+}
+
+int main(int argc, char **argv){
+    bool quick = false;
+    int repetitions = 5;
+    uint64_t seed = 1;
+    double tolerance = 1.2;
+    string out_file, baseline_file;
+    for(int i=1;i<argc;++i){
+        const string arg = argv[i];
+        auto value = [&]() -> string {
+            if(i+1 == argc) throw invalid_argument("missing value for " + arg);
+            return argv[++i];
+        };
+        if(arg == "--quick") quick = true;
+        else if(arg == "--repetitions") repetitions = stoi(value());
+        else if(arg == "--seed") seed = stoull(value());
+        else if(arg == "--out") out_file = value();
+        else if(arg == "--baseline") baseline_file = value();
+        else if(arg == "--tolerance") tolerance = stod(value());
+        else {
+            cerr << "usage: bench [--quick] [--repetitions r] [--seed s] [--out results.tsv] [--baseline old.tsv] [--tolerance 1.2]\n"
+                 << "  runs every solver on a grid of generated lps and writes a tab separated table,\n"
+                 << "  with --baseline the medians are compared and the exit code is 1 if a case got slower than tolerance times its baseline\n";
+            return arg == "--help" ? 0 : 2;
+        }
+    }
+    const vector<Bench_Solver> solvers = {
+        {"seidel", solve_seidel<false>, 10000, 1000},
+        {"simplex", solve_simplex, 1000, 1000},
+        {"clarkson_1", [](Lp_Instance lp){ return detail::clarkson_1(lp.get_A(), lp.get_c(), solve_seidel<false>); }, 100000, 10000},
+        {"clarkson_2", [](Lp_Instance lp){ return solve_clarkson(lp, solve_seidel<false>); }, 100000, 10000},
+        {"auto", [](Lp_Instance lp){ return solve_auto(lp); }, 100000, 100000},
+    };
+    const vector<string> generators = {"annulus", "spherical", "dense", "sparse", "degenerate", "prefix_sum"};
+    const vector<int> ns = quick ? vector<int>{100, 1000} : vector<int>{100, 1000, 10000, 100000};
+    const vector<int> ds = {3, 4, 6};
+
+    ostringstream table;
+    table << "case\tmedian\tp95\tallocations\tbits\tobjective\n";
+    map<string, double> baseline;
+    if(!baseline_file.empty()) baseline = read_baseline(baseline_file);
+    int regressions = 0;
+    for(auto const&gen:generators){
+        for(int n:ns){
+            for(int d:ds){
+                const Lp_Instance lp = generate_lp(gen, n, d, seed);
+                unique_ptr<Bench_Result> first;
+                for(auto const&solver:solvers){
+                    if(n > (d <= 4 ? solver.max_n : solver.max_n_high_d)) continue;
+                    const string name = gen + "/n=" + to_string(n) + "/d=" + to_string(d) + "/" + solver.name;
+                    Bench_Result r = run_case(name, lp, solver.solve, repetitions, seed);
+                    table << r.name << "\t" << r.median << "\t" << r.p95 << "\t" << r.allocations << "\t" << r.bits << "\t" << objective_string(r) << "\n";
+                    cerr << r.name << ": median " << r.median << "s, p95 " << r.p95 << "s";
+                    if(baseline.count(name)){
+                        const double ratio = r.median / baseline[name];
+                        cerr << ", " << ratio << "x baseline";
+                        if(ratio > tolerance){
+                            cerr << " [REGRESSION]";
+                            ++regressions;
+                        }
+                    }
+                    cerr << "\n";
+                    if(!first) first.reset(new Bench_Result(r));
+                    else if(r.status != first->status || (r.status == Lp_Status::OPTIMAL && r.objective != first->objective)){
+                        cerr << "[ERROR] " << name << " has objective " << objective_string(r) << ", expected " << objective_string(*first) << "\n";
+                        return 3;
+                    }
+                }
+            }
+        }
+    }
+    if(out_file.empty()) cout << table.str();
+    else ofstream(out_file) << table.str();
+    if(regressions) cerr << regressions << " regressions\n";
+    return regressions ? 1 : 0;
+}
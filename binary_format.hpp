@@ -0,0 +1,270 @@
+#ifndef BINARY_FORMAT_HPP
+#define BINARY_FORMAT_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+
+#include "fraction.hpp"
+#include "lp_instance.hpp"
+#include "lp_result.hpp"
+#include "mapped_file.hpp"
+#include "num.hpp"
+
+namespace dacin{ namespace lp{
+
+    /*
+     * Binary format, fixed width integers are little endian:
+     *   "DACINLPB", u32 version, u32 kind
+     * instance (kind 0):
+     *   u64 n, u64 d
+     *   u32 bits[d+2]          max bitlength of each column of A, then of c
+     *   u64 offsets[n+1]       start of row i in the data section, offsets[n] is the start of c
+     *   data                   the rows of A, then c
+     * result (kind 1):
+     *   u32 status, then x, ray, objective numerator and denominator, basis, dual and farkas
+     *   vectors are a varint length followed by their entries
+     * A Num is varint(2*limbs + neg) followed by its limbs as varints,
+     * varints are LEB128 and basis entries are zigzag encoded.
+     * The header of an instance has a size of 32 + 4*(d+2) bytes rounded up to a multiple of 8,
+     * so the offset table is aligned if the file is.
+     */
+    namespace detail{
+        constexpr char binary_magic[8] = {'D', 'A', 'C', 'I', 'N', 'L', 'P', 'B'};
+        constexpr uint32_t binary_version = 1;
+        constexpr uint32_t binary_kind_instance = 0, binary_kind_result = 1;
+
+        class Binary_Writer{
+        public:
+            void put_fixed(uint64_t v, int bytes){
+                for(int i=0;i<bytes;++i) data.push_back(char(v >> (8*i)));
+            }
+            void put_varint(uint64_t v){
+                while(v >= 0x80){
+                    data.push_back(char(v | 0x80));
+                    v >>= 7;
+                }
+                data.push_back(char(v));
+            }
+            void put_num(Num const&a){
+                put_varint(2*uint64_t(a.size()) + (a.size() && a.neg));
+                for(size_t i=0;i<a.size();++i) put_varint(a[i]);
+            }
+            void put_nums(vector<Num> const&v){
+                put_varint(v.size());
+                for(auto const&e:v) put_num(e);
+            }
+            void put_ints(vector<int> const&v){
+                put_varint(v.size());
+                for(int e:v) put_varint((uint64_t(e) << 1) ^ uint64_t(int64_t(e) >> 63));
+            }
+            std::string data;
+        };
+
+        class Binary_Parser{
+        public:
+            Binary_Parser(const char *begin, const char *end) : pos(begin), last(end) {}
+            uint64_t get_fixed(int bytes){
+                need(bytes);
+                uint64_t v = 0;
+                for(int i=0;i<bytes;++i) v |= uint64_t(uint8_t(pos[i])) << (8*i);
+                pos += bytes;
+                return v;
+            }
+            uint64_t get_varint(){
+                uint64_t v = 0;
+                for(int shift=0;;shift+=7){
+                    need(1);
+                    const uint8_t byte = *pos++;
+                    if(shift > 63 || (shift == 63 && byte > 1)) throw std::runtime_error("varint overflow");
+                    v |= uint64_t(byte & 0x7f) << shift;
+                    if(!(byte & 0x80)) return v;
+                }
+            }
+            void get_num(Num &a){
+                const uint64_t head = get_varint();
+                // every limb takes at least one byte
+                if(head/2 > uint64_t(last - pos)) throw std::runtime_error("unexpected end of binary data");
+                a.words.resize(head/2);
+                for(auto &e:a.words) e = get_varint();
+                a.neg = head & 1;
+                if(a.size() && !a[a.size()-1]) throw std::runtime_error("non-normalized number");
+            }
+            vector<Num> get_nums(){
+                const uint64_t n = get_varint();
+                if(n > uint64_t(last - pos)) throw std::runtime_error("unexpected end of binary data");
+                vector<Num> ret(n);
+                for(auto &e:ret) get_num(e);
+                return ret;
+            }
+            vector<int> get_ints(){
+                const uint64_t n = get_varint();
+                if(n > uint64_t(last - pos)) throw std::runtime_error("unexpected end of binary data");
+                vector<int> ret(n);
+                for(auto &e:ret){
+                    const uint64_t v = get_varint();
+                    e = int((v >> 1) ^ (~(v & 1) + 1));
+                }
+                return ret;
+            }
+            // checks magic and version and returns the kind
+            uint32_t get_header(){
+                need(sizeof(binary_magic));
+                if(std::memcmp(pos, binary_magic, sizeof(binary_magic))) throw std::runtime_error("not a binary lp file");
+                pos += sizeof(binary_magic);
+                if(get_fixed(4) != binary_version) throw std::runtime_error("unsupported binary lp version");
+                return get_fixed(4);
+            }
+            const char *pos, *last;
+        private:
+            void need(size_t bytes) const {
+                if(pos > last || size_t(last - pos) < bytes) throw std::runtime_error("unexpected end of binary data");
+            }
+        };
+
+        inline void put_binary_header(Binary_Writer &out, uint32_t kind){
+            out.data.append(binary_magic, sizeof(binary_magic));
+            out.put_fixed(binary_version, 4);
+            out.put_fixed(kind, 4);
+        }
+    }
+
+    void write_binary(std::ostream &o, Lp_Instance const&lp){
+        const size_t n = lp.n(), d = lp.d();
+        detail::Binary_Writer head, body;
+        vector<uint32_t> bits(d+2, 0);
+        vector<uint64_t> offsets;
+        offsets.reserve(n+1);
+        for(auto const&row:lp.get_A()){
+            offsets.push_back(body.data.size());
+            for(size_t j=0;j<=d;++j){
+                bits[j] = std::max<uint32_t>(bits[j], row[j].bitlength());
+                body.put_num(row[j]);
+            }
+        }
+        offsets.push_back(body.data.size());
+        for(auto const&e:lp.get_c()){
+            bits[d+1] = std::max<uint32_t>(bits[d+1], e.bitlength());
+            body.put_num(e);
+        }
+        detail::put_binary_header(head, detail::binary_kind_instance);
+        head.put_fixed(n, 8);
+        head.put_fixed(d, 8);
+        for(auto e:bits) head.put_fixed(e, 4);
+        while(head.data.size() % 8) head.data.push_back(0);
+        for(auto e:offsets) head.put_fixed(e, 8);
+        o.write(head.data.data(), head.data.size());
+        o.write(body.data.data(), body.data.size());
+    }
+
+    void write_binary(std::ostream &o, Lp_Result const&res){
+        detail::Binary_Writer out;
+        detail::put_binary_header(out, detail::binary_kind_result);
+        out.put_fixed(uint32_t(res.get_status()), 4);
+        out.put_nums(res.get_x());
+        out.put_nums(res.get_ray());
+        out.put_num(res.get_objective().numerator());
+        out.put_num(res.get_objective().denominator());
+        out.put_ints(res.get_basis());
+        out.put_nums(res.get_dual());
+        out.put_nums(res.get_farkas());
+        o.write(out.data.data(), out.data.size());
+    }
+
+    /*
+     * Read-only view of a binary instance in memory, e.g. in a Mapped_File.
+     * Nothing is copied up front, rows are decoded on access.
+     * The buffer has to outlive the view.
+     */
+    class Binary_Lp_View{
+    public:
+        Binary_Lp_View(const char *begin, const char *end) : last(end) {
+            detail::Binary_Parser in(begin, end);
+            if(in.get_header() != detail::binary_kind_instance) throw std::runtime_error("binary file does not contain an lp");
+            n_ = in.get_fixed(8);
+            d_ = in.get_fixed(8);
+            if(n_ > uint64_t(std::numeric_limits<int>::max()) || d_ > uint64_t(std::numeric_limits<int>::max())) throw std::runtime_error("invalid lp size");
+            bits = in.pos;
+            const size_t offset_pos = (32 + 4*(d_+2) + 7) / 8 * 8;
+            if(offset_pos + 8*(n_+1) > size_t(end - begin)) throw std::runtime_error("unexpected end of binary data");
+            offsets = begin + offset_pos;
+            data = offsets + 8*(n_+1);
+            // read_row trusts that the rows are in order
+            for(uint64_t i=0, prev=0;i<=n_;++i){
+                const uint64_t cur = offset(i);
+                if(cur < prev) throw std::runtime_error("invalid row offset");
+                prev = cur;
+            }
+        }
+        explicit Binary_Lp_View(Mapped_File const&file) : Binary_Lp_View(file.begin(), file.end()) {}
+
+        int n() const { return n_; }
+        int d() const { return d_; }
+        // max bitlength of column j of A, j == d is the constant column
+        uint32_t column_bits(int j) const { return fixed(bits + 4*j, 4); }
+        uint32_t objective_bits() const { return fixed(bits + 4*(d_+1), 4); }
+
+        void read_row(int i, vector<Num> &row) const {
+            assert(0 <= i && i < n());
+            detail::Binary_Parser in(data + offset(i), data + offset(i+1));
+            row.resize(d_+1);
+            for(auto &e:row) in.get_num(e);
+        }
+        vector<Num> row(int i) const {
+            vector<Num> ret;
+            read_row(i, ret);
+            return ret;
+        }
+        vector<Num> objective() const {
+            detail::Binary_Parser in(data + offset(n_), last);
+            vector<Num> ret(d_);
+            for(auto &e:ret) in.get_num(e);
+            return ret;
+        }
+        Lp_Instance to_instance() const {
+            vector<vector<Num> > A(n_);
+            for(int i=0;i<n();++i) read_row(i, A[i]);
+            return Lp_Instance(move(A), objective());
+        }
+    private:
+        static uint64_t fixed(const char *p, int bytes){
+            return detail::Binary_Parser(p, p + bytes).get_fixed(bytes);
+        }
+        uint64_t offset(size_t i) const {
+            const uint64_t ret = fixed(offsets + 8*i, 8);
+            if(ret > uint64_t(last - data)) throw std::runtime_error("invalid row offset");
+            return ret;
+        }
+        const char *last, *bits, *offsets, *data;
+        uint64_t n_, d_;
+    };
+
+    Lp_Result read_binary_result(const char *begin, const char *end){
+        detail::Binary_Parser in(begin, end);
+        if(in.get_header() != detail::binary_kind_result) throw std::runtime_error("binary file does not contain an lp result");
+        const uint32_t status = in.get_fixed(4);
+        if(status > uint32_t(Lp_Status::CANCELLED)) throw std::runtime_error("invalid lp status");
+        vector<Num> x = in.get_nums(), ray = in.get_nums();
+        Num numer, denom;
+        in.get_num(numer);
+        in.get_num(denom);
+        Lp_Result ret(Lp_Status(status), move(x), move(ray), Fraction(move(numer), move(denom)));
+        ret.set_basis(in.get_ints());
+        ret.set_dual(in.get_nums());
+        ret.set_farkas(in.get_nums());
+        return ret;
+    }
+
+    Lp_Instance read_binary_lp_file(std::string const&filename){
+        Mapped_File file(filename);
+        return Binary_Lp_View(file).to_instance();
+    }
+    Lp_Result read_binary_result_file(std::string const&filename){
+        Mapped_File file(filename);
+        return read_binary_result(file.begin(), file.end());
+    }
+
+} }
+#endif // BINARY_FORMAT_HPP
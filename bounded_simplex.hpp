@@ -0,0 +1,184 @@
+#ifndef BOUNDED_SIMPLEX_HPP
+#define BOUNDED_SIMPLEX_HPP
+
+#include "fraction.hpp"
+#include "lp_instance.hpp"
+#include "lp_result.hpp"
+#include "simplex.hpp"
+#include "util.hpp"
+
+namespace dacin{ namespace lp{
+
+    namespace detail{
+        // the numerators of v over their least common denominator, which is appended
+        template<typename Int>
+        vector<Int> homogeneous(vector<Basic_Fraction<Int> > v){
+            Int D(1);
+            for(auto &e:v){
+                e.normalize();
+                D = D / Int::gcd(D, e.denominator()) * e.denominator();
+            }
+            vector<Int> ret;
+            ret.reserve(v.size()+1);
+            for(auto const&e:v) ret.push_back(e.numerator() * (D / e.denominator()));
+            ret.push_back(move(D));
+            return ret;
+        }
+    }
+
+    /*
+     * Simplex with native variable bounds: rows with a single nonzero coefficient are taken as
+     * bounds of their variable instead of tableau rows, and variables without bounds are free.
+     * Each variable keeps one tableau column (solve_simplex splits it into x+ and x-) and starts at
+     * the point of its bounds closest to 0, a variable that reaches a bound is shifted so that the bound is 0.
+     * The ratio test flips the entering variable to its other bound without a pivot if that comes first.
+     * A box constrained lp with n rows and d variables gives a tableau with n - 2d rows and d columns.
+     * The certificates refer to the rows of lp like those of solve_simplex.
+     */
+    template<typename Int = Num>
+    Basic_Lp_Result<Int> solve_bounded_simplex(Basic_Lp_Instance<Int> const&lp){
+        using Lp_Result = Basic_Lp_Result<Int>;
+        using Fraction = Basic_Fraction<Int>;
+        const int n = lp.n(), d = lp.d();
+        auto const&A = lp.get_A();
+        auto const&c = lp.get_c();
+        // the tightest bound of each variable and its row, -1 if there is none
+        vector<Fraction> lower(d), upper(d);
+        vector<int> lower_row(d, -1), upper_row(d, -1), rows;
+        for(int i=0;i<n;++i){
+            int j = -1, nonzeros = 0;
+            for(int k=0;k<d;++k){
+                if(A[i][k].sign() != 0){
+                    j = k;
+                    ++nonzeros;
+                }
+            }
+            if(nonzeros != 1){
+                rows.push_back(i);
+                continue;
+            }
+            // A[i][j] x_j <= -A[i][d]
+            Fraction bound(-A[i][d], A[i][j]);
+            bound.normalize();
+            if(A[i][j].sign() > 0){
+                if(upper_row[j] == -1 || bound < upper[j]){
+                    upper[j] = move(bound);
+                    upper_row[j] = i;
+                }
+            } else {
+                if(lower_row[j] == -1 || bound > lower[j]){
+                    lower[j] = move(bound);
+                    lower_row[j] = i;
+                }
+            }
+        }
+        // x_j = offset_j + v_j with offset_j the point of [lower_j, upper_j] closest to 0
+        vector<Fraction> offset(d);
+        detail::Variable_Bounds<Int> bounds(d);
+        for(int j=0;j<d;++j){
+            const bool has_lower = lower_row[j] != -1, has_upper = upper_row[j] != -1;
+            if(has_lower && has_upper && lower[j] > upper[j]){
+                // a_u * lower row - a_l * upper row is 0 <= -t
+                const int l = lower_row[j], u = upper_row[j];
+                return Lp_Result::infeasible_result({l, u}, {A[u][j], -A[l][j]});
+            }
+            if(has_lower && lower[j].sign() > 0) offset[j] = lower[j];
+            if(has_upper && upper[j].sign() < 0) offset[j] = upper[j];
+            if(has_lower){
+                bounds.lower[j] = lower[j] - offset[j];
+                bounds.lower[j].normalize();
+            }
+            if(has_upper){
+                bounds.upper[j] = upper[j] - offset[j];
+                bounds.upper[j].normalize();
+            }
+        }
+        // the remaining rows are multiplied by the common denominator L of the offsets
+        const vector<Int> scaled_offset = detail::homogeneous(offset);
+        Int const&L = scaled_offset.back();
+        const int m = rows.size();
+        vector<vector<Int> > T(m+2, vector<Int>(d+2));
+        for(int k=0;k<m;++k){
+            auto const&row = A[rows[k]];
+            Int rhs = -(row[d] * L);
+            for(int j=0;j<d;++j){
+                if(row[j].sign() == 0) continue;
+                T[k][j] = row[j] * L;
+                if(scaled_offset[j].sign() != 0) rhs -= row[j] * scaled_offset[j];
+            }
+            T[k][d] = Int(-1);
+            T[k][d+1] = move(rhs);
+        }
+        for(int j=0;j<d;++j){
+            T[m][j] = -c[j];
+        }
+        T[m+1][d] = Int(1);
+        vector<int> basic, nonbasic;
+        Int scale;
+        const int bounded_fail = detail::run_two_phase(T, scale, basic, nonbasic, &bounds);
+
+        // multipliers of the rows of lp from the reduced costs in row x, a variable at a bound stands for its bound row
+        auto certificate = [&](const int x, vector<int> &basis, vector<Fraction> &y){
+            for(int j=0;j<=d;++j){
+                const int v = nonbasic[j];
+                if(v == -1 || T[x][j].sign() == 0) continue;
+                if(v >= d){
+                    basis.push_back(rows[v-d]);
+                    y.emplace_back(T[x][j] * L, scale);
+                } else {
+                    // the variable can't move in the improving direction, so it is at that bound
+                    const bool at_upper = (T[x][j].sign() < 0) != bool(bounds.negated[v]);
+                    const int row = at_upper ? upper_row[v] : lower_row[v];
+                    assert(row != -1);
+                    basis.push_back(row);
+                    y.emplace_back(Int::abs(T[x][j]), scale * Int::abs(A[row][v]));
+                }
+            }
+        };
+        if(bounded_fail == -2){
+            vector<int> basis;
+            vector<Fraction> y;
+            certificate(m+1, basis, y);
+            vector<Int> farkas = detail::homogeneous(move(y));
+            farkas.pop_back();
+            Lp_Result ret = Lp_Result::infeasible_result(move(basis), move(farkas));
+            ret.reduce_all();
+            return ret;
+        }
+        // v in the coordinates of the tableau, then x
+        vector<Fraction> x(d);
+        for(int i=0;i<m;++i) if(bounds.structural(basic[i])){
+            x[basic[i]] = Fraction(T[i][d+1], scale);
+        }
+        for(int j=0;j<d;++j){
+            x[j] = offset[j] + bounds.shift[j] + (bounds.negated[j] ? -x[j] : x[j]);
+        }
+        if(bounded_fail != -1){
+            const int bf = bounded_fail;
+            vector<Int> ray(d+1, 0);
+            for(int i=0;i<m;++i) if(bounds.structural(basic[i])){
+                ray[basic[i]] = -T[i][bf];
+            }
+            if(bounds.structural(nonbasic[bf])){
+                ray[nonbasic[bf]] = scale;
+            }
+            for(int j=0;j<d;++j){
+                if(bounds.negated[j]) ray[j] = -ray[j];
+            }
+            Lp_Result ret(Lp_Status::UNBOUNDED, detail::homogeneous(move(x)), move(ray), Fraction::inf());
+            ret.reduce_all();
+            return ret;
+        }
+        Lp_Result ret(Lp_Status::OPTIMAL, detail::homogeneous(move(x)), {}, Fraction());
+        vector<int> basis;
+        vector<Fraction> y;
+        certificate(m, basis, y);
+        ret.set_basis(move(basis));
+        ret.set_dual(detail::homogeneous(move(y)));
+        ret.recalc_objective(c);
+        ret.reduce_all();
+        return ret;
+    }
+
+} }
+#endif // BOUNDED_SIMPLEX_HPP
@@ -5,114 +5,322 @@
 #include "lp_instance.hpp"
 #include "lp_result.hpp"
 #include "num.hpp"
+#include "profile.hpp"
 #include "seidel.hpp"
 #include "simplex.hpp"
+#include "solve_context.hpp"
 #include "util.hpp"
 
 namespace dacin{ namespace lp{
 
-    using Backend = Lp_Result(*)(Lp_Instance);
+    // a solver for the small lps of the clarkson algorithms
+    template<typename Int>
+    using Basic_Backend = Basic_Lp_Result<Int>(*)(Basic_Lp_Instance<Int>);
+    using Backend = Basic_Backend<Num>;
+
+    /*
+     * Sample sizes and thresholds of the clarkson algorithms.
+     * The defaults are the constants of the textbook analysis.
+     * In adaptive mode the sample sizes start at the defaults and are adjusted after every round:
+     * they grow after failed rounds (too many violators) and shrink while the
+     * sub-solves take much longer than the violation scans.
+     */
+    struct Clarkson_Policy{
+        // clarkson_1 samples sample_1 * d^2 constraints
+        double sample_1 = 6;
+        // clarkson_2 falls back to clarkson_1 for at most base_2 * d^2 constraints
+        double base_2 = 9;
+        // clarkson_2 samples sample_2 * d * sqrt(n) constraints
+        double sample_2 = 1;
+        // clarkson_1 doubles the violators if their weight is at most the total weight / (reweight_1 * d)
+        double reweight_1 = 3;
+        // clarkson_2 keeps the violators if there are at most keep_2 * sqrt(n) of them
+        double keep_2 = 2;
+        bool adaptive = false;
+        // bounds for the factor applied to the sample sizes in adaptive mode
+        double min_scale = 0.25, max_scale = 4;
+    };
+
+    // per solve telemetry, counters are summed over all calls of clarkson_1
+    struct Clarkson_Stats{
+        int iterations_1 = 0, failed_rounds_1 = 0;
+        int iterations_2 = 0, failed_rounds_2 = 0;
+        double sub_solve_seconds = 0, scan_seconds = 0;
+        // violators[b] counts the rounds of clarkson_2 with a number of violators of bitlength b
+        vector<int64_t> violators;
+        // sample size of the last round of clarkson_2
+        int64_t last_sample = 0;
+
+        void add_violators(int64_t count){
+            int b = 0;
+            while(count >> b) ++b;
+            if((int)violators.size() <= b) violators.resize(b+1);
+            ++violators[b];
+        }
+        friend std::ostream& operator<<(std::ostream&o, Clarkson_Stats const&s){
+            o << "clarkson_1: " << s.iterations_1 << " iterations, " << s.failed_rounds_1 << " failed\n";
+            o << "clarkson_2: " << s.iterations_2 << " iterations, " << s.failed_rounds_2 << " failed, last sample " << s.last_sample << "\n";
+            o << "sub-solves " << s.sub_solve_seconds << "s, scans " << s.scan_seconds << "s\n";
+            o << "violators:";
+            for(size_t b=0;b<s.violators.size();++b){
+                o << " [" << (b ? int64_t(1) << (b-1) : 0) << "," << (int64_t(1) << b) << "):" << s.violators[b];
+            }
+            return o << "\n";
+        }
+    };
+
     namespace detail{
+        // keeps a parameter out of template argument deduction, so that lambdas convert to a Basic_Backend
+        template<typename T>
+        struct Non_Deduced{
+            using type = T;
+        };
+        using Clock = std::chrono::steady_clock;
+        double seconds_since(Clock::time_point start){
+            return std::chrono::duration<double>(Clock::now() - start).count();
+        }
+        // adjusts scale after a round, failed rounds grow the sample, expensive sub-solves shrink it
+        void adapt_scale(Clarkson_Policy const&policy, double &scale, bool failed, double sub_solve, double scan){
+            if(!policy.adaptive) return;
+            if(failed) scale *= 1.5;
+            else if(sub_solve > 2*scan) scale *= 0.8;
+            scale = std::min(policy.max_scale, std::max(policy.min_scale, scale));
+        }
         template<typename T>
         T randint(T l, T r){
             return std::uniform_int_distribution<T>(l, r)(rng);
         }
-        Lp_Result clarkson_1(vector<vector<Num> > const&A, vector<Num> const&c, Backend backend){
-            const int n = A.size(), d = c.size();
-            const int k = 6*d*d;
-            vector<int64_t> weight(n, 1);
-            if(n <= k) return backend(std::move(Lp_Instance(A, c)));
-            auto get_sublp = [&A, &c, &weight, n, d, k](){
-                int64_t total_weight = std::accumulate(weight.begin(), weight.end(), int64_t{0});
-                vector<int64_t> samples;
-                while((int)samples.size() < k){
-                    int64_t new_sample = randint<int64_t>(0, total_weight-1);
-                    if(!std::count(samples.begin(), samples.end(), new_sample)){
-                        samples.push_back(new_sample);
+        /*
+         * Weights 2^e_i with O(log n) sampling proportional to the weight and O(log n) doubling.
+         * The weights are kept as doubles in a fenwick tree, all exponents are shifted down
+         * before they could overflow.
+         */
+        class Weighted_Sampler{
+        public:
+            explicit Weighted_Sampler(int n) : exponent(n, 0), tree(n+1, 0) {
+                rebuild();
+            }
+            double weight(int i) const {
+                return std::ldexp(1.0, exponent[i] - shift);
+            }
+            double total() const {
+                return total_weight;
+            }
+            void double_weight(int i){
+                if(++exponent[i] - shift > max_exponent){
+                    shift += max_exponent/2;
+                    rebuild();
+                    return;
+                }
+                const double w = weight(i) / 2;
+                total_weight += w;
+                for(int j=i+1;j<(int)tree.size();j+=j&-j) tree[j] += w;
+            }
+            // random index, drawn with probability proportional to its weight
+            int draw() const {
+                double target = std::uniform_real_distribution<double>(0, total_weight)(rng);
+                int pos = 0;
+                for(int step = highest_bit(tree.size()-1);step;step/=2){
+                    if(pos + step < (int)tree.size() && tree[pos+step] <= target){
+                        pos += step;
+                        target -= tree[pos];
                     }
                 }
-                std::sort(samples.begin(), samples.end());
-                int64_t weight_pre = 0;
-                vector<vector<Num> > A_sub;
-                for(int i=0, j=0; i<n && j<k; ++i){
-                    weight_pre += weight[i];
-                    if(samples[j] < weight_pre){
-                        A_sub.push_back(A[i]);
-                        ++j;
+                return std::min(pos, (int)exponent.size()-1);
+            }
+        private:
+            static constexpr int max_exponent = 900;
+            static int highest_bit(size_t n){
+                int ret = 1;
+                while((size_t)ret*2 <= n) ret *= 2;
+                return n ? ret : 0;
+            }
+            void rebuild(){
+                std::fill(tree.begin(), tree.end(), 0);
+                total_weight = 0;
+                for(size_t i=0;i<exponent.size();++i){
+                    tree[i+1] += weight(i);
+                    total_weight += weight(i);
+                    const size_t j = (i+1) + ((i+1) & -(i+1));
+                    if(j < tree.size()) tree[j] += tree[i+1];
+                }
+            }
+            vector<int> exponent;
+            vector<double> tree;
+            double total_weight = 0;
+            int shift = 0;
+        };
+        template<typename Int>
+        Basic_Lp_Result<Int> clarkson_1(vector<vector<Int> > const&A, vector<Int> const&c, typename Non_Deduced<Basic_Backend<Int> >::type backend,
+                Clarkson_Policy const&policy = Clarkson_Policy(), Clarkson_Stats *stats = nullptr){
+            using Lp_Instance = Basic_Lp_Instance<Int>;
+            const int n = A.size(), d = c.size();
+            double scale = 1;
+            auto sample_size = [&](){ return std::max(d+1, (int)llround(scale * policy.sample_1 * d*d)); };
+            if(n <= sample_size()){
+                if(stats) ++stats->iterations_1;
+                return backend(std::move(Lp_Instance(A, c)));
+            }
+            // the backend only sees samples
+            Relaxation_Scope relaxation;
+            Weighted_Sampler weight(n);
+            // drawn[i] == round if row i is in the sample of this round
+            vector<int> drawn(n, -1);
+            vector<int> ids;
+            auto get_sublp = [&A, &c, &weight, &drawn, &ids](int round, int k){
+                // k draws with replacement, duplicates are dropped
+                ids.clear();
+                for(int i=0;i<k;++i){
+                    const int j = weight.draw();
+                    if(drawn[j] != round){
+                        drawn[j] = round;
+                        ids.push_back(j);
                     }
                 }
+                std::sort(ids.begin(), ids.end());
+                vector<vector<Int> > A_sub;
+                A_sub.reserve(ids.size());
+                for(auto const&e:ids) A_sub.push_back(A[e]);
                 return Lp_Instance(std::move(A_sub), c);
             };
-            vector<bool> is_violated(n);
-            for(size_t iter = 0;;++iter){
-                auto res = backend(std::move(get_sublp()));
+            vector<int> violators;
+            for(int iter = 0;;++iter){
+                DACIN_LP_PROFILE_EVENT(CLARKSON_1_ITERATION);
+                solve_checkpoint(Solver_Event::CLARKSON_1_ITERATION);
+                if(stats) ++stats->iterations_1;
+                Clock::time_point start = Clock::now();
+                auto res = backend(std::move(get_sublp(iter, std::min(n, sample_size()))));
+                const double sub_solve = seconds_since(start);
+                res.map_basis(ids);
                 if(!res.is_feasible()){
+                    if(stats) stats->sub_solve_seconds += sub_solve;
                     return res;
                 }
-                int64_t violated_weight = 0;
-                int64_t total_weight = 0;
+                // the sample is a relaxation of the lp
+                if(res.is_bounded()) report_bound(res.get_objective().numerator(), res.get_objective().denominator(), true);
+                start = Clock::now();
+                double violated_weight = 0;
+                violators.clear();
                 for(int i=0;i<n;++i){
-                    is_violated[i] = res.violates(A[i]);
-                    total_weight+=weight[i];
-                    if(is_violated[i]){
-                        violated_weight+=weight[i];
+                    if(res.violates(A[i])){
+                        violators.push_back(i);
+                        violated_weight += weight.weight(i);
                     }
                 }
-                if(violated_weight == 0){
+                const double scan = seconds_since(start);
+                DACIN_LP_PROFILE_SCAN(n, scan);
+                if(stats){
+                    stats->sub_solve_seconds += sub_solve;
+                    stats->scan_seconds += scan;
+                }
+                if(violators.empty()){
                     // std::cerr << "Clarkson 1 iter: " << iter << "\n";
                     return res;
                 }
-                if(violated_weight * 3 * d <= total_weight){
-                    for(int i=0;i<n;++i){
-                        if(is_violated[i]) weight[i]*=2;
-                    }
+                const bool failed = violated_weight * policy.reweight_1 * d > weight.total();
+                if(!failed){
+                    for(auto const&e:violators) weight.double_weight(e);
+                } else if(stats){
+                    ++stats->failed_rounds_1;
                 }
+                adapt_scale(policy, scale, failed, sub_solve, scan);
             }
         }
-        Lp_Result clarkson_2(vector<vector<Num> > const&A, vector<Num> const&c, Backend backend){
+        // hint: constraints that are always kept in the sample (e.g. the basis of a similar lp)
+        // tight: if not null, receives the constraints that are tight for the returned result
+        template<typename Int>
+        Basic_Lp_Result<Int> clarkson_2(vector<vector<Int> > const&A, vector<Int> const&c, typename Non_Deduced<Basic_Backend<Int> >::type backend,
+                vector<int> const&hint = {}, vector<int> *tight = nullptr, Clarkson_Policy const&policy = Clarkson_Policy(), Clarkson_Stats *stats = nullptr){
             const int n = A.size(), d = c.size();
-            if(n <= 9*d*d){
-                return clarkson_1(A, c, backend);
+            if(tight) tight->clear();
+            if(n <= policy.base_2*d*d){
+                Basic_Lp_Result<Int> res = clarkson_1(A, c, backend, policy, stats);
+                if(tight && res.is_feasible()){
+                    for(int i=0;i<n;++i){
+                        if(res.slack_sign(A[i]) == 0) tight->push_back(i);
+                    }
+                }
+                return res;
             }
             const int root_n = llround(sqrt(n));
-            const int k = d * root_n;
-            vector<vector<Num> > A_sub;
+            double scale = 1;
+            Relaxation_Scope relaxation;
+            vector<vector<Int> > A_sub;
+            vector<int> ids;
+            for(auto const&e:hint){
+                A_sub.push_back(A[e]);
+                ids.push_back(e);
+            }
             for(;;){
                 const int s = A_sub.size();
+                const int k = std::min<int64_t>(n, std::max<int64_t>(d+1, llround(scale * policy.sample_2 * d * root_n)));
                 for(int i=0;i<k;++i){
-                    A_sub.push_back(A[randint<int>(0, n-1)]);
+                    ids.push_back(randint<int>(0, n-1));
+                    A_sub.push_back(A[ids.back()]);
+                }
+                DACIN_LP_PROFILE_EVENT(CLARKSON_2_ITERATION);
+                solve_checkpoint(Solver_Event::CLARKSON_2_ITERATION);
+                if(stats){
+                    ++stats->iterations_2;
+                    stats->last_sample = A_sub.size();
                 }
-                auto res = clarkson_1(A_sub, c, backend);
+                Clock::time_point start = Clock::now();
+                auto res = clarkson_1(A_sub, c, backend, policy, stats);
+                const double sub_solve = seconds_since(start);
+                res.map_basis(ids);
                 A_sub.erase(A_sub.begin()+s, A_sub.end());
+                ids.erase(ids.begin()+s, ids.end());
                 if(!res.is_feasible()){
                     return res;
                 }
+                start = Clock::now();
                 vector<int> violators;
+                if(tight) tight->clear();
                 for(int i=0;i<n;++i){
-                    if(res.violates(A[i])) violators.push_back(i);
+                    const int sign = res.slack_sign(A[i]);
+                    if(sign > 0) violators.push_back(i);
+                    else if(sign == 0 && tight) tight->push_back(i);
+                }
+                const double scan = seconds_since(start);
+                DACIN_LP_PROFILE_SCAN(n, scan);
+                if(stats){
+                    stats->scan_seconds += scan;
+                    stats->add_violators(violators.size());
                 }
                 if(violators.empty()){
                     return res;
                 }
-                if((int)violators.size() <= 2*root_n){
+                const bool failed = violators.size() > policy.keep_2*root_n;
+                if(!failed){
                     for(auto &e:violators){
                         A_sub.push_back(A[e]);
+                        ids.push_back(e);
                     }
+                } else if(stats){
+                    ++stats->failed_rounds_2;
                 }
+                adapt_scale(policy, scale, failed, sub_solve, scan);
             }
         }
     }
-    Lp_Result solve_clarkson(Lp_Instance const&lp, Backend backend){
-        Lp_Result res = detail::clarkson_2(lp.get_A(), lp.get_c(), backend);
+    template<typename Int>
+    Basic_Lp_Result<Int> solve_clarkson(Basic_Lp_Instance<Int> const&lp, typename detail::Non_Deduced<Basic_Backend<Int> >::type backend){
+        Basic_Lp_Result<Int> res = detail::clarkson_2(lp.get_A(), lp.get_c(), backend);
         return res;
     }
+    template<typename Int>
+    Basic_Lp_Result<Int> solve_clarkson(Basic_Lp_Instance<Int> const&lp, typename detail::Non_Deduced<Basic_Backend<Int> >::type backend,
+            Clarkson_Policy const&policy, Clarkson_Stats *stats = nullptr){
+        return detail::clarkson_2(lp.get_A(), lp.get_c(), backend, {}, nullptr, policy, stats);
+    }
 
-    template<bool move_to_front = false>
-    Lp_Result solve_clarkson_seidel(Lp_Instance const&lp){
-        return solve_clarkson(lp, solve_seidel<move_to_front>);
+    template<bool move_to_front = false, typename Int = Num>
+    Basic_Lp_Result<Int> solve_clarkson_seidel(Basic_Lp_Instance<Int> const&lp){
+        return solve_clarkson(lp, solve_seidel<move_to_front, Int>);
     }
-    Lp_Result solve_clarkson_simplex(Lp_Instance const&lp){
-        return solve_clarkson(lp, solve_simplex);
+    template<typename Int = Num>
+    Basic_Lp_Result<Int> solve_clarkson_simplex(Basic_Lp_Instance<Int> const&lp){
+        return solve_clarkson(lp, solve_simplex<Int>);
     }
 
 } }
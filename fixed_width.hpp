@@ -0,0 +1,153 @@
+#ifndef FIXED_WIDTH_HPP
+#define FIXED_WIDTH_HPP
+
+#include <stdexcept>
+
+#include "clarkson.hpp"
+#include "lp_instance.hpp"
+#include "lp_result.hpp"
+#include "num.hpp"
+#include "number_types.hpp"
+#include "seidel.hpp"
+#include "simplex.hpp"
+#include "util.hpp"
+
+namespace dacin{ namespace lp{
+
+    /*
+     * Bounds on the bitlength of every number that seidel or the simplex compute for an lp,
+     * also when they are run on subsets of its rows by clarkson.
+     * b is the largest bitlength of a coefficient of the lp, lg(k) = ceil(log2(k)).
+     *
+     * seidel: a projection onto a constraint maps coefficients of B bits to 2B+1 bits,
+     *     so the lp of recursion level L has coefficients of B_L = 2^L (b+1) - 1 bits.
+     *     Lifting the solution (and the certificates) back up adds B_L + lg(d+2) bits per level
+     *     and checking a row of level L against it another B_L + lg(d+2) bits.
+     * simplex: after the gcd reduction every tableau entry divides a minor of order at most d+2
+     *     of the initial tableau (the two columns of a variable are negatives of each other),
+     *     so by the hadamard bound it has at most M = (d+2) b + (d+2)/2 log2(d+2) bits.
+     *     The steepest edge comparison multiplies two products of entries, one summed over n+1 rows,
+     *     which gives 4M + lg(n+2) bits.
+     * Both bounds include a sign bit and the sums of multipliers of equal rows done by clarkson.
+     */
+    struct Width_Bounds{
+        size_t input_bits = 0;
+        size_t seidel_bits = 0;
+        size_t simplex_bits = 0;
+    };
+
+    // integer types in order of width
+    enum class Int_Type{
+        INT64, INT128, INT256, NUM
+    };
+
+    namespace detail{
+        size_t ceil_log2(size_t k){
+            size_t ret = 0;
+            while((size_t(1) << ret) < k) ++ret;
+            return ret;
+        }
+        // saturates instead of overflowing, huge bounds only need to compare as huge
+        size_t saturated_add(size_t a, size_t b){
+            return a > SIZE_MAX - b ? SIZE_MAX : a + b;
+        }
+        size_t saturated_mul(size_t a, size_t b){
+            return a && b > SIZE_MAX / a ? SIZE_MAX : a * b;
+        }
+        size_t seidel_width(size_t b, size_t n, size_t d){
+            if(d == 0) return b + 2;
+            vector<size_t> B(d);
+            B[0] = b;
+            for(size_t L=1;L<d;++L) B[L] = saturated_add(saturated_mul(2, B[L-1]), 1);
+            const size_t lg = ceil_log2(d+2);
+            // the base case compares products of two coefficients
+            size_t ret = saturated_add(saturated_mul(2, B[d-1]), 1);
+            // bits of the solution (and certificate) of level L, the 1-dimensional base case has coefficients as entries
+            size_t X = B[d-1];
+            for(size_t L=d;L-->0;){
+                if(L+1 < d) X = saturated_add(X, saturated_add(B[L], lg));
+                ret = std::max(ret, saturated_add(X, saturated_add(B[L], lg)));
+            }
+            // the objective c * x of the top level
+            ret = std::max(ret, saturated_add(X, b + lg));
+            return saturated_add(ret, ceil_log2(n+1) + 1);
+        }
+        size_t simplex_width(size_t b, size_t n, size_t d){
+            const double k = d+2;
+            const size_t M = (size_t)std::ceil(k * b + k / 2 * std::log2(k));
+            return saturated_add(saturated_mul(4, M), ceil_log2(n+2) + 2);
+        }
+    }
+
+    Width_Bounds analyze_width(Lp_Instance const&lp){
+        Width_Bounds ret;
+        for(auto const&e:lp.get_A()){
+            for(auto const&f:e) ret.input_bits = std::max(ret.input_bits, f.bitlength());
+        }
+        for(auto const&e:lp.get_c()) ret.input_bits = std::max(ret.input_bits, e.bitlength());
+        ret.input_bits = std::max<size_t>(ret.input_bits, 1);
+        ret.seidel_bits = detail::seidel_width(ret.input_bits, lp.n(), lp.d());
+        ret.simplex_bits = detail::simplex_width(ret.input_bits, lp.n(), lp.d());
+        return ret;
+    }
+
+    // the narrowest type that holds signed numbers of the given bitlength
+    Int_Type narrowest_type(size_t bits){
+        if(bits < 64) return Int_Type::INT64;
+        if(bits < 128) return Int_Type::INT128;
+        if(bits < 256) return Int_Type::INT256;
+        return Int_Type::NUM;
+    }
+
+    /*
+     * Converts lp to type, calls solve on it and converts the result back.
+     * solve is called with a Basic_Lp_Instance of the chosen type, e.g. [](auto lp){ return solve_simplex(lp); }
+     * Throws std::overflow_error if a fixed width type overflows.
+     */
+    template<typename Solve>
+    Lp_Result solve_with_type(Int_Type type, Lp_Instance const&lp, Solve solve){
+        switch(type){
+            case Int_Type::INT64:
+                return convert_result<Num>(solve(convert_lp<Int64>(lp)));
+            case Int_Type::INT128:
+                return convert_result<Num>(solve(convert_lp<Int128>(lp)));
+            case Int_Type::INT256:
+                return convert_result<Num>(solve(convert_lp<Int256>(lp)));
+            case Int_Type::NUM:
+                break;
+        }
+        return solve(lp);
+    }
+
+    /*
+     * Solves lp with the narrowest type that is proven to hold all numbers of size bits.
+     * The bounds are worst case bounds and far from tight for most lps, if speculative is set
+     * a lp without a proven fixed width type is tried with Int128 and Int256 first.
+     * Overflows are always detected, the solve is then repeated with the next wider type, so the result is exact.
+     */
+    template<typename Solve>
+    Lp_Result solve_fixed_width(Lp_Instance const&lp, size_t bits, Solve solve, bool speculative = true){
+        Int_Type type = narrowest_type(bits);
+        if(type == Int_Type::NUM && speculative){
+            // any solve multiplies coefficients with each other
+            type = narrowest_type(2*analyze_width(lp).input_bits + detail::ceil_log2(lp.d()+2) + 1);
+            if(type == Int_Type::INT64) type = Int_Type::INT128;
+        }
+        for(;;type = Int_Type(int(type)+1)){
+            try {
+                return solve_with_type(type, lp, solve);
+            } catch(std::overflow_error const&){
+                assert(type != Int_Type::NUM);
+            }
+        }
+    }
+
+    Lp_Result solve_clarkson_seidel_fixed_width(Lp_Instance const&lp, bool speculative = true){
+        return solve_fixed_width(lp, analyze_width(lp).seidel_bits, [](auto lp_t){ return solve_clarkson_seidel(lp_t); }, speculative);
+    }
+    Lp_Result solve_clarkson_simplex_fixed_width(Lp_Instance const&lp, bool speculative = true){
+        return solve_fixed_width(lp, analyze_width(lp).simplex_bits, [](auto lp_t){ return solve_clarkson_simplex(lp_t); }, speculative);
+    }
+
+} }
+#endif // FIXED_WIDTH_HPP
@@ -1,22 +1,93 @@
 #ifndef FRACTION_HPP
 #define FRACTION_HPP
 
+#include <cmath>
+
 #include "num.hpp"
 
 namespace dacin{ namespace lp{
 
-    class Fraction{
+    namespace detail{
+        /*
+         * Compares a/b with c/d for b, d >= 0, x/0 is sign(x) * infinity.
+         * Decides by the signs, then by the bitlengths, then by a double estimate and only
+         * cross-multiplies if the fractions are too close for that.
+         */
+        template<typename Int>
+        int cmp_fraction(Int const&a, Int const&b, Int const&c, Int const&d){
+            const int sa = a.sign(), sc = c.sign();
+            if(sa != sc){ // fix -inf < inf, also ignores the sign bit of 0
+                return sa < sc ? -1 : 1;
+            }
+            if(sa == 0) return 0;
+            if(b.sign() == 0 || d.sign() == 0){
+                return sa * (d.sign() - b.sign());
+            }
+            // 2^(e-1) < |a/b| < 2^(e+1) for e = bitlength(a) - bitlength(b)
+            const long e_ab = long(a.bitlength()) - long(b.bitlength());
+            const long e_cd = long(c.bitlength()) - long(d.bitlength());
+            if(e_ab >= e_cd + 2) return sa;
+            if(e_cd >= e_ab + 2) return -sa;
+            // the quotients are normal doubles and have a relative error below 2^-40
+            if(std::max(std::max(a.bitlength(), b.bitlength()), std::max(c.bitlength(), d.bitlength())) <= 960){
+                const double x = a.to_double() / b.to_double(), y = c.to_double() / d.to_double();
+                if(std::abs(x - y) > 1e-10 * std::max(std::abs(x), std::abs(y))){
+                    return x < y ? -1 : 1;
+                }
+            }
+            return Int::cmp(a * d, b * c);
+        }
+    }
+
+    /*
+     * a / b with b >= 0, for any integer type with the interface of Num (see number_types.hpp)
+     * 1/0 and -1/0 are +-infinity.
+     * The gcd of a and b is only divided out once they have doubled in size since the last reduction,
+     * so a fraction is not in lowest terms unless normalize() is called. Comparisons don't depend on it.
+     */
+    template<typename Int>
+    class Basic_Fraction{
+        using Fraction = Basic_Fraction;
     public:
-        Fraction() : a(0), b(1) {}
-        explicit Fraction(Num x) : a(std::move(x)), b(1) {}
-        Fraction(Num numerator, Num denominator) : a(std::move(numerator)), b(std::move(denominator)) { fix_sign(); }
+        Basic_Fraction() : a(0), b(1), reduced_size(2) {}
+        explicit Basic_Fraction(Int x) : a(std::move(x)), b(1) { mark_reduced(); }
+        Basic_Fraction(Int numerator, Int denominator) : a(std::move(numerator)), b(std::move(denominator)) {
+            fix_sign();
+            mark_reduced();
+        }
 
         static Fraction inf(){return Fraction(1, 0);}
 
+        int sign() const { return a.sign(); }
+        // not necessarily in lowest terms
+        Int const& numerator() const { return a; }
+        Int const& denominator() const { return b; }
+
+        // divides out the gcd, afterwards a / b is the canonical representation
+        void normalize(){
+            if(b.sign() == 0){
+                a = Int(a.sign());
+            } else if(a.sign() == 0){
+                b = Int(1);
+            } else {
+                const Int g = Int::gcd(Int::abs(a), b);
+                if(g != Int(1)){
+                    a /= g;
+                    b /= g;
+                }
+            }
+            mark_reduced();
+        }
+
         Fraction& operator+=(Fraction const&o){
-            a *= o.b;
-            a += b*o.a;
-            b *= o.b;
+            if(b == o.b){
+                a += o.a;
+            } else {
+                a *= o.b;
+                Int::addmul_long(a, b, o.a);
+                b *= o.b;
+            }
+            lazy_normalize();
             return *this;
         }
         Fraction operator+(Fraction const&o) const {
@@ -25,9 +96,15 @@ namespace dacin{ namespace lp{
             return ret;
         }
         Fraction& operator-=(Fraction const&o){
-            a *= o.b;
-            a += b*o.a;
-            b *= o.b;
+            if(b == o.b){
+                a -= o.a;
+            } else {
+                a *= o.b;
+                // copies the numerator instead of building the product b*o.a
+                Int::addmul_long(a, b, -o.a);
+                b *= o.b;
+            }
+            lazy_normalize();
             return *this;
         }
         Fraction operator-(Fraction const&o) const {
@@ -39,6 +116,8 @@ namespace dacin{ namespace lp{
         Fraction& operator*=(Fraction const&o){
             a*=o.a;
             b*=o.b;
+            fix_sign();
+            lazy_normalize();
             return *this;
         }
         Fraction operator*(Fraction const&o) const {
@@ -49,6 +128,8 @@ namespace dacin{ namespace lp{
         Fraction& operator/=(Fraction const&o){
             a*=o.b;
             b*=o.a;
+            fix_sign();
+            lazy_normalize();
             return *this;
         }
         Fraction operator/(Fraction const&o) const {
@@ -61,10 +142,7 @@ namespace dacin{ namespace lp{
         }
 
         int cmp(Fraction const&o) const {
-            if(a.neg != o.a.neg){ // fix -inf < inf
-                return a.neg ? -1 : 1;
-            }
-            return Num::cmp(a * o.b, b * o.a);
+            return detail::cmp_fraction(a, b, o.a, o.b);
         }
         #define DECLARE_CMP_OP(op)\
         bool operator op (Fraction const&o) const{\
@@ -85,19 +163,29 @@ namespace dacin{ namespace lp{
 
     private:
         void fix_sign(){
-            if(a == Num(0)){
-                if(b != Num(0)){
-                    b = Num(1);
+            if(a.sign() == 0){
+                if(b.sign() != 0){
+                    b = Int(1);
                 }
             } else {
-                if(b < Num(0)){
-                    a.set_neg(-a.neg);
-                    b.set_neg(false);
+                if(b.sign() < 0){
+                    a = -a;
+                    b = -b;
                 }
             }
         }
-        Num a, b;
+        void mark_reduced(){
+            reduced_size = std::max<size_t>(a.size() + b.size(), 2);
+        }
+        // a gcd costs more than a few multiplications, so it is only done once the size doubled
+        void lazy_normalize(){
+            if(a.size() + b.size() > 2*reduced_size) normalize();
+        }
+        Int a, b;
+        size_t reduced_size;
     };
 
+    using Fraction = Basic_Fraction<Num>;
+
 } }
 #endif // FRACTION_HPP
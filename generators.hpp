@@ -0,0 +1,161 @@
+#ifndef GENERATORS_HPP
+#define GENERATORS_HPP
+
+#include <random>
+#include <string>
+
+#include "lp_instance.hpp"
+#include "num.hpp"
+#include "util.hpp"
+
+namespace dacin{ namespace lp{
+
+    /*
+     * Deterministic lp generators for benchmarks, the same seed always gives the same lp.
+     * d is the number of variables of the generated lp.
+     */
+    namespace detail{
+        int64_t gen_int(std::mt19937_64 &gen, int64_t l, int64_t r){
+            return std::uniform_int_distribution<int64_t>(l, r)(gen);
+        }
+        // rows of the enclosing annulus lp for points in dimension d-2:
+        // variables (center, u, v) with |p|^2 - 2 p*center <= v and >= u, maximize u - v
+        Lp_Instance annulus_lp(vector<vector<int64_t> > const&points, int d){
+            vector<vector<Num> > A;
+            for(int sign : {-1, 1}){
+                for(auto const&p:points){
+                    vector<Num> row(d+1);
+                    int64_t norm = 0;
+                    for(int j=0;j<d-2;++j){
+                        row[j] = Num(int(2*sign*p[j]));
+                        norm += p[j]*p[j];
+                    }
+                    row[sign < 0 ? d-1 : d-2] = Num(sign < 0 ? -1 : 1);
+                    row[d] = Num(int(-sign*norm));
+                    A.push_back(move(row));
+                }
+            }
+            vector<Num> c(d);
+            c[d-2] = Num(1);
+            c[d-1] = Num(-1);
+            return Lp_Instance(move(A), move(c));
+        }
+    }
+
+    // enclosing annulus of n/2 random points with coordinates in [0, 2000), d >= 3
+    Lp_Instance generate_annulus(int n, int d, uint64_t seed){
+        std::mt19937_64 gen(seed);
+        vector<vector<int64_t> > points(std::max(1, n/2), vector<int64_t>(d-2));
+        for(auto &p:points) for(auto &e:p) e = detail::gen_int(gen, 0, 1999);
+        return detail::annulus_lp(points, d);
+    }
+
+    // enclosing annulus of n/2 integer points close to a sphere of radius 1000, very degenerate
+    Lp_Instance generate_spherical_annulus(int n, int d, uint64_t seed){
+        std::mt19937_64 gen(seed);
+        std::normal_distribution<double> normal;
+        vector<vector<int64_t> > points(std::max(1, n/2), vector<int64_t>(d-2));
+        for(auto &p:points){
+            vector<double> dir(d-2);
+            double len = 0;
+            while(len < 1e-9){
+                len = 0;
+                for(auto &e:dir){
+                    e = normal(gen);
+                    len += e*e;
+                }
+            }
+            for(int j=0;j<d-2;++j) p[j] = llround(1000 * dir[j] / sqrt(len));
+        }
+        return detail::annulus_lp(points, d);
+    }
+
+    // n random rows a*x <= b with b > 0 and nonzeros of a in [-1000, 1000], plus a box |x_j| <= 10^6
+    // nonzeros: number of nonzero coefficients per row, d for dense rows
+    Lp_Instance generate_random(int n, int d, int nonzeros, uint64_t seed){
+        std::mt19937_64 gen(seed);
+        vector<vector<Num> > A;
+        for(int j=0;j<d;++j){
+            for(int sign : {-1, 1}){
+                vector<Num> row(d+1);
+                row[j] = Num(sign);
+                row[d] = Num(-1000000);
+                A.push_back(move(row));
+            }
+        }
+        vector<int> columns(d);
+        std::iota(columns.begin(), columns.end(), 0);
+        for(int i=2*d;i<n;++i){
+            vector<Num> row(d+1);
+            std::shuffle(columns.begin(), columns.end(), gen);
+            for(int k=0;k<std::min(nonzeros, d);++k) row[columns[k]] = Num(int(detail::gen_int(gen, -1000, 1000)));
+            row[d] = Num(-int(detail::gen_int(gen, 1, 1000000)));
+            A.push_back(move(row));
+        }
+        vector<Num> c(d);
+        for(auto &e:c) e = Num(int(detail::gen_int(gen, -1000, 1000)));
+        return Lp_Instance(move(A), move(c));
+    }
+
+    // n random rows that are all tight at the optimum x = (1, ..., 1), plus a box, highly degenerate
+    Lp_Instance generate_degenerate(int n, int d, uint64_t seed){
+        std::mt19937_64 gen(seed);
+        vector<vector<Num> > A;
+        for(int j=0;j<d;++j){
+            vector<Num> row(d+1);
+            row[j] = Num(-1);
+            row[d] = Num(-1000);
+            A.push_back(move(row));
+        }
+        // c is a positive combination of the rows, so (1, ..., 1) is optimal
+        vector<Num> c(d);
+        for(int i=d;i<n;++i){
+            vector<Num> row(d+1);
+            Num sum(0);
+            for(int j=0;j<d;++j){
+                row[j] = Num(int(detail::gen_int(gen, 1, 100)));
+                sum += row[j];
+                c[j] += row[j];
+            }
+            row[d] = -sum;
+            A.push_back(move(row));
+        }
+        return Lp_Instance(move(A), move(c));
+    }
+
+    // the prefix sum lp of opencup.cpp with n items, weights in [1, 100] and d groups
+    Lp_Instance generate_prefix_sum(int n, int d, uint64_t seed){
+        std::mt19937_64 gen(seed);
+        vector<vector<Num> > A;
+        vector<Num> b, c(d);
+        c[0] = Num(1);
+        for(int i=1;i<d;++i){
+            A.emplace_back(d);
+            A.back()[i] = Num(-1);
+            b.emplace_back(0);
+        }
+        A.emplace_back(d, Num(-1));
+        A.back()[0] = Num(0);
+        b.emplace_back(-1);
+        vector<Num> pre(d, Num(0));
+        for(int i=0;i<n;++i){
+            pre[i ? detail::gen_int(gen, 0, d-1) : 0] += Num(int(detail::gen_int(gen, 1, 100)));
+            A.push_back(pre);
+            b.emplace_back(0);
+        }
+        return Lp_Instance(move(A), move(b), move(c));
+    }
+
+    // generator by name: annulus, spherical, dense, sparse, degenerate or prefix_sum
+    Lp_Instance generate_lp(std::string const&name, int n, int d, uint64_t seed){
+        if(name == "annulus") return generate_annulus(n, d, seed);
+        if(name == "spherical") return generate_spherical_annulus(n, d, seed);
+        if(name == "dense") return generate_random(n, d, d, seed);
+        if(name == "sparse") return generate_random(n, d, 2, seed);
+        if(name == "degenerate") return generate_degenerate(n, d, seed);
+        if(name == "prefix_sum") return generate_prefix_sum(n, d, seed);
+        throw std::invalid_argument("unknown generator " + name);
+    }
+
+} }
+#endif // GENERATORS_HPP
@@ -0,0 +1,165 @@
+#ifndef INCREMENTAL_HPP
+#define INCREMENTAL_HPP
+
+#include "clarkson.hpp"
+#include "lp_instance.hpp"
+#include "lp_result.hpp"
+#include "num.hpp"
+#include "seidel.hpp"
+#include "util.hpp"
+
+namespace dacin{ namespace lp{
+
+    /*
+     * Keeps an lp together with its last result and the constraints that were tight for it.
+     * After small changes, solve() restarts from the old tight constraints:
+     * it solves the lp restricted to a small working set with the backend and
+     * adds violated constraints to it until the solution is feasible for all constraints.
+     * Every round costs one O(n*d) violation scan, a re-solve after
+     * adding constraints that are all satisfied only scans the new ones.
+     */
+    class Incremental_Solver{
+    public:
+        Incremental_Solver(Lp_Instance const&lp, Backend backend_ = solve_seidel<false>) : A(lp.get_A()), c(lp.get_c()), backend(backend_) {}
+
+        // returns the index of the first added constraint
+        int add_constraints(vector<vector<Num> > rows){
+            const int first = A.size();
+            for(auto &e:rows){
+                assert(e.size() == c.size()+1);
+                added.push_back(A.size());
+                A.push_back(move(e));
+            }
+            return first;
+        }
+        // indices refer to the current numbering, the remaining constraints keep their order
+        void remove_constraints(vector<int> indices){
+            const int n = A.size();
+            vector<int> new_index(n, 0);
+            for(auto const&e:indices){
+                assert(0 <= e && e < n);
+                new_index[e] = -1;
+            }
+            int m = 0;
+            for(int i=0;i<n;++i){
+                if(new_index[i] == -1) continue;
+                new_index[i] = m;
+                if(m != i) A[m] = move(A[i]);
+                ++m;
+            }
+            A.resize(m);
+            auto remap = [&new_index](vector<int> &v){
+                int m = 0;
+                for(auto const&e:v){
+                    if(new_index[e] != -1) v[m++] = new_index[e];
+                }
+                const bool lost = m != (int)v.size();
+                v.resize(m);
+                return lost;
+            };
+            if(remap(tight)) tight_removed = true;
+            remap(added);
+            any_removed = true;
+            if(!solved) return;
+            // the basis of the cached result follows the renumbering, if a basis row is gone it is solved again
+            bool basis_removed = false;
+            for(auto const&e:result.get_basis()){
+                if(new_index[e] == -1) basis_removed = true;
+            }
+            if(basis_removed) tight_removed = true;
+            else result.map_basis(new_index);
+        }
+        void set_objective(vector<Num> c_){
+            assert(c_.size() == c.size());
+            c = move(c_);
+            objective_changed = true;
+        }
+
+        Lp_Result const& solve(){
+            if(!solved){
+                return solve_cold();
+            }
+            if(!result.is_feasible()){
+                // adding constraints or changing the objective keeps the lp infeasible
+                if(any_removed) return solve_cold();
+                return finish();
+            }
+            if(!objective_changed && !tight_removed){
+                // the old solution stays optimal unless one of the new constraints is violated
+                bool violated = false;
+                for(auto const&e:added){
+                    const int sign = result.slack_sign(A[e]);
+                    if(sign > 0){
+                        violated = true;
+                        break;
+                    }
+                    if(sign == 0) tight.push_back(e);
+                }
+                if(!violated) return finish();
+            }
+            return solve_warm();
+        }
+
+        Lp_Result const& get_result() const { return result; }
+        vector<int> const& get_tight() const { return tight; }
+        Lp_Instance get_lp() const { return Lp_Instance(A, c); }
+        int n() const { return A.size(); }
+        int d() const { return c.size(); }
+
+    private:
+        Lp_Result const& finish(){
+            solved = true;
+            added.clear();
+            any_removed = tight_removed = objective_changed = false;
+            return result;
+        }
+        Lp_Result const& solve_cold(){
+            result = detail::clarkson_2(A, c, backend, {}, &tight);
+            return finish();
+        }
+        Lp_Result const& solve_warm(){
+            const int n = A.size(), d = c.size();
+            const size_t max_working_set = 9*d*d;
+            vector<int> working_set = tight;
+            for(;;){
+                vector<vector<Num> > A_sub;
+                for(auto const&e:working_set){
+                    A_sub.push_back(A[e]);
+                }
+                Lp_Result res = backend(Lp_Instance(move(A_sub), c));
+                res.map_basis(working_set);
+                if(!res.is_feasible()){
+                    result = move(res);
+                    tight.clear();
+                    return finish();
+                }
+                vector<int> violators, new_tight;
+                for(int i=0;i<n;++i){
+                    const int sign = res.slack_sign(A[i]);
+                    if(sign > 0) violators.push_back(i);
+                    else if(sign == 0) new_tight.push_back(i);
+                }
+                if(violators.empty()){
+                    result = move(res);
+                    tight = move(new_tight);
+                    return finish();
+                }
+                if(working_set.size() + violators.size() > max_working_set){
+                    // too far away from the old solution
+                    result = detail::clarkson_2(A, c, backend, working_set, &tight);
+                    return finish();
+                }
+                working_set.insert(working_set.end(), violators.begin(), violators.end());
+            }
+        }
+
+        vector<vector<Num> > A;
+        vector<Num> c;
+        Backend backend;
+        Lp_Result result;
+        vector<int> tight, added;
+        bool solved = false, any_removed = false, tight_removed = false, objective_changed = false;
+    };
+
+} }
+#endif // INCREMENTAL_HPP
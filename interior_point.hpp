@@ -0,0 +1,308 @@
+#ifndef INTERIOR_POINT_HPP
+#define INTERIOR_POINT_HPP
+
+#include <chrono>
+#include <cmath>
+#include <numeric>
+
+#include "bounded_simplex.hpp"
+#include "lp_instance.hpp"
+#include "lp_result.hpp"
+#include "modular.hpp"
+#include "profile.hpp"
+#include "solve_context.hpp"
+#include "util.hpp"
+#include "verify.hpp"
+
+namespace dacin{ namespace lp{
+
+    struct Interior_Point_Options{
+        int max_iterations = 100;
+        // relative primal and dual residuals and duality gap at which the iteration stops
+        double tolerance = 1e-9;
+        // threads of the modular basis solve
+        int threads = 1;
+        // exact solver for the lps the crossover doesn't certify, solve_bounded_simplex if null
+        Lp_Result (*fallback)(Lp_Instance) = nullptr;
+    };
+
+    struct Interior_Point_Stats{
+        int iterations = 0;
+        bool converged = false;
+        // the basis found by the crossover gave a verified optimal vertex, otherwise the fallback solved the lp
+        bool certified = false;
+        double ipm_seconds = 0, crossover_seconds = 0, fallback_seconds = 0;
+    };
+
+    namespace detail{
+        // the lp in doubles, equilibrated: a few rounds of scaling rows and columns of A to a largest coefficient of 1
+        struct Float_Lp{
+            int n, d;
+            vector<vector<double> > A;
+            vector<double> b, c;
+        };
+        Float_Lp to_float_lp(Lp_Instance const&lp){
+            Float_Lp ret;
+            const int n = ret.n = lp.n(), d = ret.d = lp.d();
+            ret.A.assign(n, vector<double>(d));
+            ret.b.resize(n);
+            for(int i=0;i<n;++i){
+                auto const&row = lp.get_A()[i];
+                for(int j=0;j<d;++j) ret.A[i][j] = row[j].to_double();
+                ret.b[i] = -row[d].to_double();
+            }
+            ret.c = to_doubles(lp.get_c());
+            // column scaling substitutes x_j by x_j / scale_j, which the crossover doesn't care about
+            vector<double> col(d);
+            for(int round=0;round<4;++round){
+                for(int i=0;i<n;++i){
+                    double norm = 0;
+                    for(auto const&e:ret.A[i]) norm = std::max(norm, std::abs(e));
+                    if(norm == 0) norm = std::max(1.0, std::abs(ret.b[i]));
+                    for(auto &e:ret.A[i]) e /= norm;
+                    ret.b[i] /= norm;
+                }
+                std::fill(col.begin(), col.end(), 0.0);
+                for(auto const&e:ret.A){
+                    for(int j=0;j<d;++j) col[j] = std::max(col[j], std::abs(e[j]));
+                }
+                for(int j=0;j<d;++j) if(col[j] == 0) col[j] = 1;
+                for(auto &e:ret.A){
+                    for(int j=0;j<d;++j) e[j] /= col[j];
+                }
+                for(int j=0;j<d;++j) ret.c[j] /= col[j];
+            }
+            double norm = 0;
+            for(auto const&e:ret.c) norm = std::max(norm, std::abs(e));
+            if(norm > 0) for(auto &e:ret.c) e /= norm;
+            return ret;
+        }
+        // cholesky factorization of a symmetric positive semidefinite M in place, tiny pivots are regularized
+        void cholesky(vector<vector<double> > &M){
+            const int d = M.size();
+            double max_diag = 0;
+            for(int j=0;j<d;++j) max_diag = std::max(max_diag, M[j][j]);
+            const double eps = 1e-14 * std::max(max_diag, 1e-300);
+            for(int j=0;j<d;++j){
+                double diag = M[j][j];
+                for(int k=0;k<j;++k) diag -= M[j][k] * M[j][k];
+                M[j][j] = std::sqrt(std::max(diag, eps));
+                for(int i=j+1;i<d;++i){
+                    double sum = M[i][j];
+                    for(int k=0;k<j;++k) sum -= M[i][k] * M[j][k];
+                    M[i][j] = sum / M[j][j];
+                }
+            }
+        }
+        void cholesky_solve(vector<vector<double> > const&L, vector<double> &x){
+            const int d = L.size();
+            for(int i=0;i<d;++i){
+                for(int k=0;k<i;++k) x[i] -= L[i][k] * x[k];
+                x[i] /= L[i][i];
+            }
+            for(int i=d;i-->0;){
+                for(int k=i+1;k<d;++k) x[i] -= L[k][i] * x[k];
+                x[i] /= L[i][i];
+            }
+        }
+        // the largest step in (0, 1] that keeps v + step * dv positive, damped
+        double max_step(vector<double> const&v, vector<double> const&dv){
+            double step = 1;
+            for(size_t i=0;i<v.size();++i){
+                if(dv[i] < 0) step = std::min(step, -0.995 * v[i] / dv[i]);
+            }
+            return step;
+        }
+        /*
+         * Mehrotra predictor corrector on the pair
+         *     max c x  s.t.  A x + s = b, s >= 0    and    min b y  s.t.  A^T y = c, y >= 0.
+         * Each iteration solves the normal equations A^T (Y/S) A dx = r with a d x d cholesky factorization.
+         * Returns whether the residuals and the gap reached the tolerance, s and y give the optimal face.
+         */
+        bool interior_point(Float_Lp const&lp, Interior_Point_Options const&options, vector<double> &x, vector<double> &s, vector<double> &y, int &iterations){
+            const int n = lp.n, d = lp.d;
+            auto const&A = lp.A;
+            x.assign(d, 0);
+            s.resize(n);
+            y.assign(n, 1);
+            for(int i=0;i<n;++i) s[i] = std::max(std::abs(lp.b[i]), 1.0);
+            double b_norm = 0, c_norm = 0;
+            for(auto const&e:lp.b) b_norm = std::max(b_norm, std::abs(e));
+            for(auto const&e:lp.c) c_norm = std::max(c_norm, std::abs(e));
+            vector<double> r_p(n), r_d(d), rc(n), dx(d), ds(n), dy(n), dx_a(d), ds_a(n), dy_a(n), tmp(n);
+            vector<vector<double> > M(d, vector<double>(d));
+            // the newton step for the complementarity target rc with the factorized M
+            auto solve_step = [&](vector<double> &dx, vector<double> &ds, vector<double> &dy){
+                for(int i=0;i<n;++i) tmp[i] = (rc[i] + y[i] * r_p[i]) / s[i];
+                for(int j=0;j<d;++j){
+                    double sum = -r_d[j];
+                    for(int i=0;i<n;++i) sum -= A[i][j] * tmp[i];
+                    dx[j] = sum;
+                }
+                cholesky_solve(M, dx);
+                for(int i=0;i<n;++i){
+                    double ax = 0;
+                    for(int j=0;j<d;++j) ax += A[i][j] * dx[j];
+                    ds[i] = -r_p[i] - ax;
+                    dy[i] = (rc[i] - y[i] * ds[i]) / s[i];
+                }
+            };
+            for(iterations=0;iterations<options.max_iterations;++iterations){
+                DACIN_LP_PROFILE_EVENT(INTERIOR_POINT_ITERATION);
+                solve_checkpoint(Solver_Event::INTERIOR_POINT_ITERATION);
+                double p_res = 0, d_res = 0, gap = 0, obj = 0;
+                for(int i=0;i<n;++i){
+                    double ax = 0;
+                    for(int j=0;j<d;++j) ax += A[i][j] * x[j];
+                    r_p[i] = ax + s[i] - lp.b[i];
+                    p_res = std::max(p_res, std::abs(r_p[i]));
+                    gap += y[i] * s[i];
+                }
+                for(int j=0;j<d;++j){
+                    double aty = 0;
+                    for(int i=0;i<n;++i) aty += A[i][j] * y[i];
+                    r_d[j] = aty - lp.c[j];
+                    d_res = std::max(d_res, std::abs(r_d[j]));
+                    obj += lp.c[j] * x[j];
+                }
+                if(p_res <= options.tolerance * (1 + b_norm) && d_res <= options.tolerance * (1 + c_norm) && gap <= options.tolerance * (1 + std::abs(obj))){
+                    return true;
+                }
+                if(!std::isfinite(gap) || !std::isfinite(p_res) || !std::isfinite(d_res)) return false;
+                const double mu = gap / n;
+                for(auto &e:M) std::fill(e.begin(), e.end(), 0.0);
+                for(int i=0;i<n;++i){
+                    const double w = y[i] / s[i];
+                    for(int j=0;j<d;++j){
+                        if(A[i][j] == 0) continue;
+                        const double wa = w * A[i][j];
+                        for(int k=0;k<=j;++k) M[j][k] += wa * A[i][k];
+                    }
+                }
+                cholesky(M);
+                // predictor
+                for(int i=0;i<n;++i) rc[i] = -y[i] * s[i];
+                solve_step(dx_a, ds_a, dy_a);
+                const double step_p = max_step(s, ds_a), step_d = max_step(y, dy_a);
+                double mu_aff = 0;
+                for(int i=0;i<n;++i) mu_aff += (s[i] + step_p * ds_a[i]) * (y[i] + step_d * dy_a[i]);
+                mu_aff /= n;
+                const double sigma = std::pow(mu_aff / mu, 3);
+                // corrector
+                for(int i=0;i<n;++i) rc[i] = -y[i] * s[i] - ds_a[i] * dy_a[i] + sigma * mu;
+                solve_step(dx, ds, dy);
+                const double alpha_p = max_step(s, ds), alpha_d = max_step(y, dy);
+                for(int j=0;j<d;++j) x[j] += alpha_p * dx[j];
+                for(int i=0;i<n;++i){
+                    s[i] += alpha_p * ds[i];
+                    y[i] += alpha_d * dy[i];
+                }
+            }
+            return false;
+        }
+        /*
+         * d linearly independent rows, taken greedily in order of s_i / y_i so that tight rows with
+         * large multipliers come first. Empty if the rows have rank below d.
+         */
+        vector<int> crossover_basis(Float_Lp const&lp, vector<double> const&s, vector<double> const&y){
+            const int n = lp.n, d = lp.d;
+            vector<int> order(n);
+            std::iota(order.begin(), order.end(), 0);
+            vector<double> key(n);
+            for(int i=0;i<n;++i) key[i] = s[i] / std::max(y[i], 1e-300);
+            std::sort(order.begin(), order.end(), [&key](int a, int b){ return key[a] < key[b]; });
+            vector<int> basis;
+            // orthonormal basis of the span of the chosen rows, modified gram schmidt with reorthogonalization
+            vector<vector<double> > Q;
+            vector<double> r(d);
+            for(int i : order){
+                if((int)basis.size() == d) break;
+                r = lp.A[i];
+                double norm = 0;
+                for(auto const&e:r) norm += e*e;
+                if(norm == 0) continue;
+                for(int pass=0;pass<2;++pass){
+                    for(auto const&q:Q){
+                        double dot = 0;
+                        for(int j=0;j<d;++j) dot += q[j] * r[j];
+                        for(int j=0;j<d;++j) r[j] -= dot * q[j];
+                    }
+                }
+                double rest = 0;
+                for(auto const&e:r) rest += e*e;
+                if(rest <= 1e-16 * norm) continue;
+                rest = std::sqrt(rest);
+                for(auto &e:r) e /= rest;
+                Q.push_back(r);
+                basis.push_back(i);
+            }
+            if((int)basis.size() != d) basis.clear();
+            return basis;
+        }
+    }
+
+    /*
+     * Floating point front end for lps with a larger d, where seidel is exponential in d and the exact simplex is slow:
+     * an interior point method finds an approximate optimum, the crossover picks d independent rows of its optimal face
+     * and solve_basis_modular computes the exact vertex and multipliers of that basis, which verify_result certifies.
+     * If that basis isn't optimal (a degenerate vertex), the rows of the optimal face are solved exactly on their own.
+     * If the iteration doesn't converge (the lp may be infeasible or unbounded) or the basis isn't optimal,
+     * the lp is solved by options.fallback (solve_bounded_simplex by default) instead, so the result is always exact.
+     */
+    Lp_Result solve_interior_point(Lp_Instance const&lp, Interior_Point_Options const&options = Interior_Point_Options(), Interior_Point_Stats *stats = nullptr){
+        using Clock = std::chrono::steady_clock;
+        auto seconds_since = [](Clock::time_point start){ return std::chrono::duration<double>(Clock::now() - start).count(); };
+        auto start = Clock::now();
+        Interior_Point_Stats local_stats;
+        if(!stats) stats = &local_stats;
+        *stats = Interior_Point_Stats();
+        if(lp.d() > 0 && lp.n() >= lp.d()){
+            const detail::Float_Lp float_lp = detail::to_float_lp(lp);
+            vector<double> x, s, y;
+            stats->converged = detail::interior_point(float_lp, options, x, s, y, stats->iterations);
+            stats->ipm_seconds = seconds_since(start);
+            if(stats->converged){
+                start = Clock::now();
+                const vector<int> basis = detail::crossover_basis(float_lp, s, y);
+                if(!basis.empty()){
+                    Lp_Result res = solve_basis_modular(lp, basis, options.threads);
+                    if(res.get_status() == Lp_Status::OPTIMAL && verify_result(lp, res)){
+                        res.reduce_all();
+                        stats->certified = true;
+                        stats->crossover_seconds = seconds_since(start);
+                        return res;
+                    }
+                }
+                // at a degenerate vertex the basis may have negative multipliers, then the rows of the
+                // optimal face (s_i < y_i) are solved exactly, their optimum is optimal for lp if it is feasible
+                vector<int> active;
+                for(int i=0;i<lp.n();++i) if(s[i] < y[i]) active.push_back(i);
+                if((int)active.size() >= lp.d() && 2*active.size() <= (size_t)lp.n()){
+                    vector<vector<Num> > A_active;
+                    for(int i : active) A_active.push_back(lp.get_A()[i]);
+                    Lp_Instance active_lp(move(A_active), lp.get_c());
+                    Lp_Result res;
+                    {
+                        detail::Relaxation_Scope relaxation;
+                        res = options.fallback ? options.fallback(move(active_lp)) : solve_bounded_simplex(active_lp);
+                    }
+                    if(res.get_status() == Lp_Status::OPTIMAL){
+                        res.map_basis(active);
+                        if(verify_result(lp, res)){
+                            stats->certified = true;
+                            stats->crossover_seconds = seconds_since(start);
+                            return res;
+                        }
+                    }
+                }
+                stats->crossover_seconds = seconds_since(start);
+            }
+        }
+        start = Clock::now();
+        Lp_Result res = options.fallback ? options.fallback(lp) : solve_bounded_simplex(lp);
+        stats->fallback_seconds = seconds_since(start);
+        return res;
+    }
+
+} }
+#endif // INTERIOR_POINT_HPP
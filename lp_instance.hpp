@@ -7,14 +7,17 @@
 
 #include "fraction.hpp"
 #include "num.hpp"
+#include "number_types.hpp"
 
 namespace dacin{ namespace lp{
 
-    class Lp_Instance{
+    template<typename Int>
+    class Basic_Lp_Instance{
+        using Lp_Instance = Basic_Lp_Instance;
     public:
-        Lp_Instance() {}
-        Lp_Instance(std::vector<std::vector<Num> > A_, std::vector<Num> c_) : A(std::move(A_)), c(std::move(c_)) { for(auto const&e:A) assert(e.size() == c.size()+1); }
-        Lp_Instance(std::vector<std::vector<Num> > A_, std::vector<Num> b, std::vector<Num> c_) : A(std::move(A_)), c(std::move(c_)) {
+        Basic_Lp_Instance() {}
+        Basic_Lp_Instance(std::vector<std::vector<Int> > A_, std::vector<Int> c_) : A(std::move(A_)), c(std::move(c_)) { for(auto const&e:A) assert(e.size() == c.size()+1); }
+        Basic_Lp_Instance(std::vector<std::vector<Int> > A_, std::vector<Int> b, std::vector<Int> c_) : A(std::move(A_)), c(std::move(c_)) {
             assert(A.size() == b.size());
             for(size_t i=0;i<A.size();++i){
                 assert(A[i].size() == c.size());
@@ -24,12 +27,12 @@ namespace dacin{ namespace lp{
         friend std::istream& operator>>(std::istream&in, Lp_Instance &lp){
             int n, d;
             in >> n >> d;
-            std::vector<std::vector<Num> > A(n, std::vector<Num>(d+1));
-            std::vector<Num> c(d);
+            std::vector<std::vector<Int> > A(n, std::vector<Int>(d+1));
+            std::vector<Int> c(d);
             std::string s;
-            auto read_num = [&in, &s](Num&f){
+            auto read_num = [&in, &s](Int&f){
                 in >> s;
-                f = std::move(Num(s.c_str()));
+                f = std::move(Int(s.c_str()));
             };
             for(auto &e:A) for(auto &f:e) read_num(f);
             for(auto &e:c) read_num(e);
@@ -39,9 +42,8 @@ namespace dacin{ namespace lp{
         }
         friend std::ostream& operator<<(std::ostream&o, Lp_Instance const&lp){
             o << lp.A.size() << " " << lp.c.size() << "\n";
-            auto write_num = [&o](Num const&f){
-                int g; assert(f.can_convert_to_int(&g));
-                o << g;
+            auto write_num = [&o](Int const&f){
+                o << f;
             };
             for(auto &e:lp.A){
                 for(auto &f:e) {
@@ -58,10 +60,10 @@ namespace dacin{ namespace lp{
             return o;
         }
 
-        std::vector<std::vector<Num> > const& get_A() const { return A; }
-        std::vector<Num> const& get_c() const { return c; }
-        void set_A(std::vector<std::vector<Num> > A_) { A = std::move(A_); }
-        void set_c(std::vector<Num> c_) { c = std::move(c_); }
+        std::vector<std::vector<Int> > const& get_A() const { return A; }
+        std::vector<Int> const& get_c() const { return c; }
+        void set_A(std::vector<std::vector<Int> > A_) { A = std::move(A_); }
+        void set_c(std::vector<Int> c_) { c = std::move(c_); }
         int n() const { return A.size(); }
         int d() const { return c.size(); }
     private:
@@ -69,9 +71,20 @@ namespace dacin{ namespace lp{
          * maximize    c * x
          * subject to  A * (x|1) <= 0
          */
-        std::vector<std::vector<Num> > A;
-        std::vector<Num> c;
+        std::vector<std::vector<Int> > A;
+        std::vector<Int> c;
     };
 
+    using Lp_Instance = Basic_Lp_Instance<Num>;
+
+    // the same lp with the coefficients converted to another integer type
+    template<typename To, typename From>
+    Basic_Lp_Instance<To> convert_lp(Basic_Lp_Instance<From> const&lp){
+        std::vector<std::vector<To> > A;
+        A.reserve(lp.n());
+        for(auto const&e:lp.get_A()) A.push_back(convert_numbers<To>(e));
+        return Basic_Lp_Instance<To>(std::move(A), convert_numbers<To>(lp.get_c()));
+    }
+
 } }
 #endif // LP_INSTANCE_HPP
@@ -0,0 +1,98 @@
+#ifndef LP_READER_HPP
+#define LP_READER_HPP
+
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+#include "lp_instance.hpp"
+#include "mapped_file.hpp"
+#include "num.hpp"
+
+namespace dacin{ namespace lp{
+
+    /*
+     * Parser for the text format read by operator>>(std::istream&, Lp_Instance&)
+     * that works directly on a character buffer, without per-token strings.
+     */
+    class Lp_Reader{
+    public:
+        Lp_Reader(const char *begin, const char *end) : pos(begin), last(end) {}
+        explicit Lp_Reader(Mapped_File const&file) : Lp_Reader(file.begin(), file.end()) {}
+
+        bool at_end(){
+            skip_whitespace();
+            return pos == last;
+        }
+        // reads the next token and checks that it equals word
+        void expect(const char *word){
+            const char *begin = next_token();
+            const size_t len = std::strlen(word);
+            if((size_t)(pos - begin) != len || std::memcmp(begin, word, len)){
+                throw std::runtime_error(std::string("expected ") + word + ", got " + std::string(begin, pos));
+            }
+        }
+        // skips over the next count tokens
+        void skip(int64_t count){
+            for(int64_t i=0;i<count;++i) next_token();
+        }
+        int64_t read_int(){
+            const char *begin = next_token();
+            const bool neg = *begin == '-';
+            if(begin + neg == pos) throw std::runtime_error("invalid integer -");
+            int64_t ret = 0;
+            for(const char *c = begin + neg;c < pos;++c){
+                if(*c < '0' || *c > '9') throw std::runtime_error("invalid integer " + std::string(begin, pos));
+                if(ret > (std::numeric_limits<int64_t>::max() - (*c - '0')) / 10) throw std::runtime_error("integer out of range " + std::string(begin, pos));
+                ret = ret * 10 + (*c - '0');
+            }
+            return neg ? -ret : ret;
+        }
+        Num read_num(){
+            const char *begin = next_token();
+            const bool neg = *begin == '-';
+            if(begin + neg == pos) throw std::runtime_error("invalid number -");
+            for(const char *c = begin + neg;c < pos;++c){
+                if(*c < '0' || *c > '9') throw std::runtime_error("invalid number " + std::string(begin, pos));
+            }
+            Num ret = Num::from_decimal(begin + neg, pos);
+            ret.set_neg(neg);
+            return ret;
+        }
+        // n d, then n rows of A and the objective
+        Lp_Instance read_instance(){
+            const int64_t n = read_int(), d = read_int();
+            if(n < 0 || d < 0 || n > std::numeric_limits<int>::max() || d > std::numeric_limits<int>::max()) throw std::runtime_error("invalid lp size");
+            std::vector<std::vector<Num> > A(n, std::vector<Num>(d+1));
+            std::vector<Num> c(d);
+            for(auto &e:A) for(auto &f:e) f = read_num();
+            for(auto &e:c) e = read_num();
+            return Lp_Instance(std::move(A), std::move(c));
+        }
+
+    private:
+        void skip_whitespace(){
+            while(pos != last && (*pos == ' ' || *pos == '\n' || *pos == '\r' || *pos == '\t')) ++pos;
+        }
+        // skips to the end of the next token and returns its start
+        const char* next_token(){
+            skip_whitespace();
+            if(pos == last) throw std::runtime_error("unexpected end of input");
+            const char *begin = pos;
+            while(pos != last && *pos != ' ' && *pos != '\n' && *pos != '\r' && *pos != '\t') ++pos;
+            return begin;
+        }
+        const char *pos, *last;
+    };
+
+    // reads a file starting with DACIN_LP followed by an lp
+    Lp_Instance read_lp_file(std::string const&filename){
+        Mapped_File file(filename);
+        Lp_Reader reader(file);
+        reader.expect("DACIN_LP");
+        return reader.read_instance();
+    }
+
+} }
+#endif // LP_READER_HPP
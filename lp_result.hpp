@@ -3,43 +3,93 @@
 
 #include "fraction.hpp"
 #include "num.hpp"
+#include "number_types.hpp"
 #include "util.hpp"
 
 namespace dacin{ namespace lp{
 
     enum class Lp_Status{
-        INFEASIBLE, OPTIMAL, UNBOUNDED, ERROR
+        // CANCELLED: stopped by its Solve_Context, see solve_context.hpp
+        INFEASIBLE, OPTIMAL, UNBOUNDED, ERROR, CANCELLED
     };
 
-    class Lp_Result{
+    template<typename Int>
+    class Basic_Lp_Result{
+        using Lp_Result = Basic_Lp_Result;
+        using Fraction = Basic_Fraction<Int>;
     public:
-        Lp_Result() : status(Lp_Status::ERROR), x(), ray(), objective(0) {}
-        Lp_Result(Lp_Status status_, vector<Num> x_, vector<Num> ray_, Fraction objective_) : status(status_), x(std::move(x_)), ray(std::move(ray_)), objective(std::move(objective_)) {}
+        Basic_Lp_Result() : status(Lp_Status::ERROR), x(), ray(), objective(0) {}
+        Basic_Lp_Result(Lp_Status status_, vector<Int> x_, vector<Int> ray_, Fraction objective_) : status(status_), x(std::move(x_)), ray(std::move(ray_)), objective(std::move(objective_)) {}
 
         static Lp_Result infeasible_result() {
             return Lp_Result(Lp_Status::INFEASIBLE, {}, {}, -Fraction::inf());
         }
+        static Lp_Result infeasible_result(vector<int> basis_, vector<Int> farkas_) {
+            Lp_Result ret = infeasible_result();
+            ret.basis = move(basis_);
+            ret.farkas = move(farkas_);
+            return ret;
+        }
 
         bool is_feasible() const {
-            assert(status != Lp_Status::ERROR);
+            assert(status != Lp_Status::ERROR && status != Lp_Status::CANCELLED);
             return status != Lp_Status::INFEASIBLE;
         }
         bool is_bounded() const {
-            assert(status != Lp_Status::ERROR);
+            assert(status != Lp_Status::ERROR && status != Lp_Status::CANCELLED);
             return status != Lp_Status::UNBOUNDED;
         }
-        vector<Num> const& get_x() const { return x; }
-        vector<Num> const& get_ray() const { return ray; }
-        void set_x(vector<Num> const& x_){ x = x_; }
-        void set_ray(vector<Num> const& ray_){ ray = ray_; }
+        Lp_Status get_status() const { return status; }
+        vector<Int> const& get_x() const { return x; }
+        vector<Int> const& get_ray() const { return ray; }
+        void set_x(vector<Int> const& x_){ x = x_; }
+        void set_ray(vector<Int> const& ray_){ ray = ray_; }
         Fraction const& get_objective() const { return objective; }
+        /*
+         * Certificates, all rows refer to the constraints of the solved lp:
+         * basis:  constraints that determine x (tight if optimal),
+         *         or that are infeasible together if the lp is infeasible
+         * dual:   if optimal, multipliers y >= 0 for the basis with denominator y.back() > 0 such that
+         *         sum_k y[k] * A[basis[k]][j] == y.back() * c[j] for all j < d,
+         *         the objective is then -sum_k y[k] * A[basis[k]][d] / y.back()
+         * farkas: if infeasible, multipliers y >= 0 for the basis such that
+         *         sum_k y[k] * A[basis[k]] == (0|t) for some t > 0
+         */
+        vector<int> const& get_basis() const { return basis; }
+        vector<Int> const& get_dual() const { return dual; }
+        vector<Int> const& get_farkas() const { return farkas; }
+        void set_basis(vector<int> basis_){ basis = move(basis_); }
+        void set_dual(vector<Int> dual_){ dual = move(dual_); }
+        void set_farkas(vector<Int> farkas_){ farkas = move(farkas_); }
+        // renumbers the basis by ids, multipliers of rows that become equal are added up
+        void map_basis(vector<int> const&ids){
+            vector<Int> &y = is_feasible() ? dual : farkas;
+            const bool has_y = y.size() >= basis.size() && !basis.empty();
+            vector<int> new_basis;
+            vector<Int> new_y;
+            for(size_t k=0;k<basis.size();++k){
+                const int i = ids[basis[k]];
+                const size_t pos = std::find(new_basis.begin(), new_basis.end(), i) - new_basis.begin();
+                if(pos == new_basis.size()){
+                    new_basis.push_back(i);
+                    if(has_y) new_y.push_back(y[k]);
+                } else if(has_y){
+                    new_y[pos] += y[k];
+                }
+            }
+            if(has_y){
+                for(size_t k=basis.size();k<y.size();++k) new_y.push_back(move(y[k]));
+                y = move(new_y);
+            }
+            basis = move(new_basis);
+        }
 
         void reset_ray() {
             assert(is_feasible());
             if(!is_bounded()) status = Lp_Status::OPTIMAL;
-            std::fill(ray.begin(), ray.end(), Num(0));
+            std::fill(ray.begin(), ray.end(), Int(0));
         }
-        void recalc_objective(vector<Num> const&c){
+        void recalc_objective(vector<Int> const&c){
             switch(status){
                 case Lp_Status::OPTIMAL:
                     objective = Fraction(scal_affine(x, c), x.back());
@@ -51,23 +101,43 @@ namespace dacin{ namespace lp{
                     objective = -Fraction::inf();
                     break;
                 case Lp_Status::ERROR:
+                case Lp_Status::CANCELLED:
                     assert(0);
             }
         }
-        void reduce_all(){ reduce_by_gcd(x); reduce_by_gcd(ray); }
-        bool violates(vector<Num> const&row) const {
+        void reduce_all(){ reduce_by_gcd(x); reduce_by_gcd(ray); reduce_by_gcd(dual); reduce_by_gcd(farkas); }
+        // 1 if row is violated, 0 if it is tight and -1 if it has slack
+        int slack_sign(vector<Int> const&row) const {
             if(!is_bounded()){
-                const int sign = Num::cmp(scal(row, ray), Num(0));
-                if(sign != 0) return sign == 1 ? true : false;
+                const int sign = scal(row, ray).sign();
+                if(sign != 0) return sign;
             }
-            return scal(row, x) > Num(0);
+            return scal(row, x).sign();
+        }
+        bool violates(vector<Int> const&row) const {
+            return slack_sign(row) > 0;
         }
 
     private:
         Lp_Status status;
-        vector<Num> x, ray;
+        vector<Int> x, ray;
         Fraction objective;
+        vector<int> basis;
+        vector<Int> dual, farkas;
     };
 
+    using Lp_Result = Basic_Lp_Result<Num>;
+
+    // the same result with all numbers converted to another integer type
+    template<typename To, typename From>
+    Basic_Lp_Result<To> convert_result(Basic_Lp_Result<From> const&res){
+        Basic_Fraction<To> objective(convert_number<To>(res.get_objective().numerator()), convert_number<To>(res.get_objective().denominator()));
+        Basic_Lp_Result<To> ret(res.get_status(), convert_numbers<To>(res.get_x()), convert_numbers<To>(res.get_ray()), move(objective));
+        ret.set_basis(res.get_basis());
+        ret.set_dual(convert_numbers<To>(res.get_dual()));
+        ret.set_farkas(convert_numbers<To>(res.get_farkas()));
+        return ret;
+    }
+
 } }
 #endif // LP_RESULT_HPP
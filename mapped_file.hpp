@@ -0,0 +1,76 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define DACIN_LP_HAS_MMAP
+#endif
+
+namespace dacin{ namespace lp{
+
+    // read-only view of a whole file, memory-mapped where available
+    class Mapped_File{
+    public:
+        explicit Mapped_File(std::string const&filename){
+            #ifdef DACIN_LP_HAS_MMAP
+            const int fd = ::open(filename.c_str(), O_RDONLY);
+            if(fd == -1) throw std::runtime_error("cannot open " + filename);
+            struct stat st;
+            if(::fstat(fd, &st) == -1){
+                ::close(fd);
+                throw std::runtime_error("cannot stat " + filename);
+            }
+            length = st.st_size;
+            if(length > 0){
+                void *ptr = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+                if(ptr == MAP_FAILED){
+                    ::close(fd);
+                    throw std::runtime_error("cannot map " + filename);
+                }
+                ::madvise(ptr, length, MADV_SEQUENTIAL);
+                mapped = static_cast<const char*>(ptr);
+            }
+            ::close(fd);
+            #else
+            std::ifstream in(filename, std::ios::binary);
+            if(!in) throw std::runtime_error("cannot open " + filename);
+            buffer.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+            length = buffer.size();
+            #endif
+        }
+        Mapped_File(Mapped_File const&) = delete;
+        Mapped_File& operator=(Mapped_File const&) = delete;
+        ~Mapped_File(){
+            #ifdef DACIN_LP_HAS_MMAP
+            if(mapped) ::munmap(const_cast<char*>(mapped), length);
+            #endif
+        }
+
+        const char* begin() const {
+            #ifdef DACIN_LP_HAS_MMAP
+            return mapped;
+            #else
+            return buffer.data();
+            #endif
+        }
+        const char* end() const { return begin() + length; }
+        size_t size() const { return length; }
+    private:
+        size_t length = 0;
+        #ifdef DACIN_LP_HAS_MMAP
+        const char *mapped = nullptr;
+        #else
+        std::vector<char> buffer;
+        #endif
+    };
+
+} }
+#endif // MAPPED_FILE_HPP
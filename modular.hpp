@@ -0,0 +1,252 @@
+#ifndef MODULAR_HPP
+#define MODULAR_HPP
+
+#include <thread>
+
+#include "lp_instance.hpp"
+#include "lp_result.hpp"
+#include "num.hpp"
+#include "solve_context.hpp"
+#include "util.hpp"
+
+namespace dacin{ namespace lp{
+
+    namespace detail{
+        uint64_t mul_mod(uint64_t a, uint64_t b, uint64_t p){
+            return uint64_t((unsigned __int128)a * b % p);
+        }
+        uint64_t sub_mod(uint64_t a, uint64_t b, uint64_t p){
+            return a >= b ? a - b : a + (p - b);
+        }
+        uint64_t pow_mod(uint64_t a, uint64_t e, uint64_t p){
+            uint64_t ret = 1;
+            for(;e;e/=2, a = mul_mod(a, a, p)){
+                if(e&1) ret = mul_mod(ret, a, p);
+            }
+            return ret;
+        }
+        uint64_t inv_mod(uint64_t a, uint64_t p){
+            return pow_mod(a, p-2, p);
+        }
+        // deterministic miller rabin, the bases suffice for all 64 bit numbers
+        bool is_prime_u64(uint64_t n){
+            if(n < 2) return false;
+            for(uint64_t a : {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37}){
+                if(n % a == 0) return n == a;
+            }
+            uint64_t d = n-1;
+            int s = 0;
+            while(d%2 == 0){
+                d /= 2;
+                ++s;
+            }
+            for(uint64_t a : {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37}){
+                uint64_t x = pow_mod(a, d, n);
+                if(x == 1 || x == n-1) continue;
+                bool composite = true;
+                for(int r=1;r<s && composite;++r){
+                    x = mul_mod(x, x, n);
+                    if(x == n-1) composite = false;
+                }
+                if(composite) return false;
+            }
+            return true;
+        }
+        // the largest primes below 2^62 in decreasing order, computed on demand
+        vector<uint64_t> const& modular_primes(size_t count){
+            static thread_local vector<uint64_t> primes;
+            for(uint64_t p = primes.empty() ? (uint64_t(1) << 62) - 1 : primes.back() - 2;primes.size() < count;p -= 2){
+                if(is_prime_u64(p)) primes.push_back(p);
+            }
+            return primes;
+        }
+        uint64_t mod_num(Num const&a, uint64_t p){
+            unsigned __int128 r = 0;
+            for(size_t i=a.size();i-->0;) r = ((r << 64) | a[i]) % p;
+            return a.neg && r ? p - uint64_t(r) : uint64_t(r);
+        }
+        Num num_from_word(uint64_t w){
+            return w ? Num(1, w) : Num(0);
+        }
+        // solves M x == rhs mod p by gauss jordan elimination, false if M is singular mod p
+        bool solve_mod_prime(vector<vector<Num> > const&M, vector<Num> const&rhs, uint64_t p, vector<uint64_t> &x){
+            const int d = M.size();
+            vector<vector<uint64_t> > T(d, vector<uint64_t>(d+1));
+            for(int i=0;i<d;++i){
+                for(int j=0;j<d;++j) T[i][j] = mod_num(M[i][j], p);
+                T[i][d] = mod_num(rhs[i], p);
+            }
+            for(int col=0;col<d;++col){
+                int pivot = col;
+                while(pivot < d && !T[pivot][col]) ++pivot;
+                if(pivot == d) return false;
+                std::swap(T[pivot], T[col]);
+                const uint64_t inv = inv_mod(T[col][col], p);
+                for(int j=col;j<=d;++j) T[col][j] = mul_mod(T[col][j], inv, p);
+                for(int i=0;i<d;++i){
+                    if(i == col || !T[i][col]) continue;
+                    const uint64_t f = T[i][col];
+                    for(int j=col;j<=d;++j) T[i][j] = sub_mod(T[i][j], mul_mod(f, T[col][j], p), p);
+                }
+            }
+            x.resize(d);
+            for(int i=0;i<d;++i) x[i] = T[i][d];
+            return true;
+        }
+        // r/s with r == a*s mod m, |r| < 2^k and 0 < s < 2^k, false if there is no such fraction in lowest terms
+        bool rational_reconstruction(Num const&a, Num const&m, size_t k, Num &r, Num &s){
+            const Num bound = Num(1) << k;
+            Num r0 = m, r1 = a, t0(0), t1(1);
+            while(Num::cmp_abs(r1, bound) >= 0){
+                const Num q = r0 / r1;
+                r0 -= q * r1;
+                std::swap(r0, r1);
+                t0 -= q * t1;
+                std::swap(t0, t1);
+            }
+            if(t1.sign() == 0 || Num::cmp_abs(t1, bound) >= 0) return false;
+            if(t1.sign() < 0){
+                r1 = -r1;
+                t1 = -t1;
+            }
+            if(r1.sign() != 0 && Num::gcd(Num::abs(r1), t1) != Num(1)) return false;
+            r = move(r1);
+            s = move(t1);
+            return true;
+        }
+        // x with M x == x.back() * rhs from the residues X mod m, false if they do not determine it yet
+        bool reconstruct_solution(vector<vector<Num> > const&M, vector<Num> const&rhs, vector<Num> const&X, Num const&m, vector<Num> &x){
+            const int d = M.size();
+            const size_t k = (m.bitlength() - 2) / 2;
+            Num D(1), r, s;
+            x.assign(d+1, Num(0));
+            for(int j=0;j<d;++j){
+                // X[j] * D is the numerator of x_j over the denominator so far
+                if(!rational_reconstruction(X[j] * D % m, m, k, r, s)) return false;
+                if(s != Num(1)){
+                    for(int l=0;l<j;++l) x[l] *= s;
+                    D *= s;
+                }
+                x[j] = move(r);
+            }
+            // reconstruction can succeed with too few primes, an exact check decides
+            for(int i=0;i<d;++i){
+                Num sum(0);
+                for(int j=0;j<d;++j) Num::addmul_long(sum, M[i][j], x[j]);
+                if(sum != D * rhs[i]) return false;
+            }
+            x[d] = move(D);
+            return true;
+        }
+    }
+
+    /*
+     * Solves M x[0..d) == x[d] * rhs for a d x d integer matrix M with a common denominator x[d] > 0.
+     * The system is solved modulo 62 bit primes, spread over num_threads threads, and the residues
+     * are combined by the chinese remainder theorem. The solution is recovered by rational reconstruction
+     * after 2, 4, 8, ... primes and accepted as soon as it satisfies the system exactly, so small solutions
+     * need few primes even if the hadamard bound of M is large. Returns false if M is singular.
+     * A cancelled solve (see solve_with_context) stops between two rounds of primes.
+     */
+    bool solve_system_modular(vector<vector<Num> > const&M, vector<Num> const&rhs, vector<Num> &x, int num_threads = 1){
+        const int d = M.size();
+        assert((int)rhs.size() == d);
+        if(d == 0){
+            x = {Num(1)};
+            return true;
+        }
+        // hadamard bound on the determinant and on the numerators by cramer's rule
+        double log_bound = 0;
+        for(int i=0;i<d;++i){
+            size_t bits = rhs[i].bitlength();
+            for(auto const&e:M[i]) bits = std::max(bits, e.bitlength());
+            log_bound += bits + 0.5 * std::log2(d+1);
+        }
+        const size_t bound_bits = (size_t)std::ceil(log_bound) + 1;
+        // primes are larger than 2^61, enough of them determine any solution
+        const size_t max_primes = (2*bound_bits + 2) / 61 + 2;
+        // the determinant has fewer prime factors above 2^61 than this
+        const size_t max_singular = bound_bits / 61 + 1;
+        num_threads = std::max(1, num_threads);
+        Num m(1);
+        vector<Num> X(d);
+        size_t used = 0, singular = 0, next_prime = 0;
+        for(size_t target = 2;;target = std::min(2*target, max_primes)){
+            // the threads of a round don't see the context of the calling thread
+            detail::solve_check();
+            const size_t batch = target - used;
+            auto const&all_primes = detail::modular_primes(next_prime + batch);
+            const vector<uint64_t> primes(all_primes.begin() + next_prime, all_primes.end());
+            next_prime += batch;
+            vector<vector<uint64_t> > residues(batch);
+            vector<char> regular(batch);
+            auto work = [&](int t){
+                for(size_t b=t;b<batch;b+=num_threads) regular[b] = detail::solve_mod_prime(M, rhs, primes[b], residues[b]);
+            };
+            if(num_threads == 1 || batch == 1){
+                work(0);
+            } else {
+                vector<std::thread> threads;
+                for(int t=0;t<num_threads;++t) threads.emplace_back(work, t);
+                for(auto &e:threads) e.join();
+            }
+            for(size_t b=0;b<batch;++b){
+                if(!regular[b]){
+                    if(++singular > max_singular) return false;
+                    continue;
+                }
+                // garner step, X += m * ((residue - X) / m mod p)
+                const uint64_t p = primes[b];
+                const uint64_t inv = detail::inv_mod(detail::mod_num(m, p), p);
+                for(int j=0;j<d;++j){
+                    const uint64_t t = detail::mul_mod(detail::sub_mod(residues[b][j], detail::mod_num(X[j], p), p), inv, p);
+                    X[j] += m * detail::num_from_word(t);
+                }
+                m *= detail::num_from_word(p);
+                ++used;
+            }
+            if(used < target) continue;
+            if(detail::reconstruct_solution(M, rhs, X, m, x)){
+                reduce_by_gcd(x);
+                return true;
+            }
+            if(used >= max_primes){
+                // with max_primes the reconstruction is guaranteed to succeed
+                assert(0);
+                return false;
+            }
+        }
+    }
+
+    /*
+     * The vertex of lp where the d constraints of basis are tight, with the multipliers of the basis
+     * that combine to c as dual, both computed by solve_system_modular.
+     * Whether x is feasible and the multipliers are nonnegative is not checked, see verify_result.
+     * The status is ERROR if the basis does not have d linearly independent constraints.
+     */
+    Lp_Result solve_basis_modular(Lp_Instance const&lp, vector<int> const&basis, int num_threads = 1){
+        const int d = lp.d();
+        if((int)basis.size() != d) return Lp_Result();
+        auto const&A = lp.get_A();
+        vector<vector<Num> > M(d, vector<Num>(d)), M_t(d, vector<Num>(d));
+        vector<Num> rhs(d);
+        for(int k=0;k<d;++k){
+            for(int j=0;j<d;++j){
+                M[k][j] = A[basis[k]][j];
+                M_t[j][k] = A[basis[k]][j];
+            }
+            rhs[k] = -A[basis[k]][d];
+        }
+        vector<Num> x, y;
+        if(!solve_system_modular(M, rhs, x, num_threads) || !solve_system_modular(M_t, lp.get_c(), y, num_threads)){
+            return Lp_Result();
+        }
+        Lp_Result ret(Lp_Status::OPTIMAL, move(x), {}, Fraction());
+        ret.set_basis(basis);
+        ret.set_dual(move(y));
+        ret.recalc_objective(lp.get_c());
+        return ret;
+    }
+
+} }
+#endif // MODULAR_HPP
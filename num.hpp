@@ -17,6 +17,9 @@
 #include <algorithm>
 #include <ostream>
 
+#include "num_config.hpp"
+#include "profile.hpp"
+
 class Num {
 public:
     typedef uint64_t word;
@@ -120,6 +123,13 @@ public:
             c++;
             neg = true;
         }
+        if (base == 10){
+            const char *end = c;
+            while (*end >= '0' && *end <= '9') end++;
+            words = from_decimal(c, end).words;
+            if (endptr) *endptr = (char*)end;
+            return;
+        }
         // read digits
         for (;*c; c++){
             mul_word(base);
@@ -130,6 +140,144 @@ public:
         if (endptr) *endptr = (char*)c;
     }
 
+    static word word_pow10(size_t k){
+        word ret = 1;
+        while (k--) ret *= 10;
+        return ret;
+    }
+
+    // decimal conversion works on chunks of 19 digits, 10^19 < 2^64
+    static size_t decimal_chunk(){
+        return 19;
+    }
+
+    // numbers of up to this many words (19 digit chunks when parsing) are converted chunk by chunk
+    static size_t& decimal_threshold(){
+        static size_t threshold = DACIN_NUM_DECIMAL_THRESHOLD;
+        return threshold;
+    }
+
+    // both operands need more words than this for karatsuba multiplication
+    static size_t& karatsuba_threshold(){
+        static size_t threshold = DACIN_NUM_KARATSUBA_THRESHOLD;
+        return threshold;
+    }
+
+    // 10^(19*2^j) at index 2*j and floor(2^(2*bitlength) / 10^(19*2^j)) at index 2*j+1, computed on demand
+    static const std::vector<Num>& decimal_powers(size_t j){
+        static thread_local std::vector<Num> table;
+        while (table.size() <= 2*j + 1){
+            Num p = table.empty() ? Num(1, word_pow10(decimal_chunk())) : table[table.size()-2] * table[table.size()-2];
+            Num r = reciprocal(p);
+            table.push_back(std::move(p));
+            table.push_back(std::move(r));
+        }
+        return table;
+    }
+
+    // floor(2^(2*bitlength) / a) for a > 0, newton iteration with doubling precision
+    static Num reciprocal(const Num &a){
+        const size_t n = a.bitlength();
+        Num one;
+        one.set_bit(2*n);
+        if (n <= 4*word_bits()) return div(one, a);
+        // the reciprocal of the leading h bits gives about h correct bits
+        const size_t h = n/2 + word_bits();
+        Num x = reciprocal(a >> (n - h));
+        x <<= n - h;
+        // x += x * (2^(2n) - a*x) / 2^(2n)
+        Num step = x * (one - a * x);
+        step >>= 2*n;
+        x += step;
+        Num rem = one - a * x;
+        while (rem.size() && rem.neg){
+            rem += a;
+            x -= Num(1);
+        }
+        while (cmp_abs(rem, a) >= 0){
+            sub_unsigned_overwrite(rem, a);
+            x += Num(1);
+        }
+        return x;
+    }
+
+    // in place division by a word, returns the remainder
+    static word div_mod_word(Num &a, word b){
+        unsigned __int128 r = 0;
+        for (size_t i = a.size(); i --> 0;){
+            r = (r << 64) | a[i];
+            a[i] = (word)(r / b);
+            r %= b;
+        }
+        a.truncate();
+        return (word)r;
+    }
+
+    // parses the digits in [begin, end), splitting at a power of 10^19 for long inputs
+    static Num from_decimal(const char *begin, const char *end){
+        const size_t chunk = decimal_chunk(), len = end - begin;
+        if (len > chunk*decimal_threshold()){
+            size_t j = 0;
+            while (chunk << (j+1) < len) j++;
+            Num ret = from_decimal(begin, end - (chunk << j));
+            ret = ret * decimal_powers(j)[2*j];
+            ret += from_decimal(end - (chunk << j), end);
+            return ret;
+        }
+        Num ret;
+        size_t first = len % chunk;
+        if (first == 0) first = chunk;
+        for (size_t l = first; begin < end; begin += l, l = chunk){
+            word w = 0;
+            for (const char *c = begin; c < begin + l; c++) w = w * 10 + (word)(*c - '0');
+            ret.mul_word(word_pow10(l));
+            ret.add_word(w);
+        }
+        return ret;
+    }
+
+    // appends the decimal digits of |a|, left padded with zeros to at least pad digits
+    static void to_decimal(const Num &a, size_t pad, std::vector<char> &text){
+        const size_t chunk = decimal_chunk();
+        if (a.size() <= decimal_threshold()){
+            std::vector<word> chunks;
+            Num tmp(a);
+            while (tmp.size() > 0) chunks.push_back(div_mod_word(tmp, word_pow10(chunk)));
+            char buf[20];
+            size_t digits = 0;
+            for (size_t i = chunks.size(); i --> 0;){
+                size_t l = 0;
+                for (word w = chunks[i]; w; w /= 10) buf[l++] = '0' + w % 10;
+                if (i + 1 != chunks.size()) while (l < chunk) buf[l++] = '0';
+                if (i + 1 == chunks.size()){
+                    digits = l + i*chunk;
+                    for (; digits < pad; digits++) text.push_back('0');
+                }
+                while (l) text.push_back(buf[--l]);
+            }
+            if (chunks.empty()) for (size_t i = 0; i < pad; i++) text.push_back('0');
+            return;
+        }
+        // split at the largest 10^(19*2^j) with 10^(2*19*2^j) = 10^(19*2^(j+1)) > a
+        size_t j = 0;
+        while (cmp_abs(decimal_powers(j+1)[2*j+2], a) <= 0) j++;
+        const Num &power = decimal_powers(j)[2*j], &inverse = decimal_powers(j)[2*j+1];
+        // barrett reduction, the estimate is at most 2 too small
+        Num q = a * inverse;
+        q >>= 2*power.bitlength();
+        q.set_neg(false);
+        Num r = a;
+        r.set_neg(false);
+        sub_unsigned_overwrite(r, q * power);
+        while (cmp_abs(r, power) >= 0){
+            sub_unsigned_overwrite(r, power);
+            q.add_word(1);
+        }
+        const size_t low = chunk << j;
+        to_decimal(q, pad > low ? pad - low : 0, text);
+        to_decimal(r, low, text);
+    }
+
     void resize(size_t n){
         words.resize(n);
     }
@@ -202,6 +350,7 @@ public:
     }
 
     static int cmp(const Num &a, const Num &b){
+        DACIN_LP_PROFILE_NUM(CMP, std::max(a.size(), b.size()));
         if (a.size() == 0 && b.size() == 0) return 0;
         if (!a.neg && !b.neg) return +cmp_abs(a, b);
         if ( a.neg &&  b.neg) return -cmp_abs(a, b);
@@ -284,7 +433,8 @@ public:
     static void addmul_long(Num &out, const Num &a, const Num &b){
         size_t na = a.size(), nb = b.size(), nc = na + nb + 1;
         //Num c(nc, 0, a.neg ^ b.neg), carries(nc, 0);
-        static Num c, carries;
+        DACIN_LP_PROFILE_NUM_TIMED(MUL, std::max(a.size(), b.size()));
+        static thread_local Num c, carries;
         c.words.assign(nc, 0); c.neg = a.neg ^ b.neg;
         carries.words.assign(nc, 0); carries.neg = 0;
         for (size_t ia = 0; ia < na; ia++){
@@ -298,7 +448,7 @@ public:
         // enable RVO
         add_unsigned_overwrite(c, carries);
         c.truncate();
-        if(c.size() == out.size()){ // add inplace if possible. This always happens when computing l^2-norms.
+        if(c.size() == out.size() && c.neg == out.neg){ // add inplace if possible. This always happens when computing l^2-norms.
             add_unsigned_overwrite(out, c);
         } else {
             out+=c;
@@ -319,12 +469,15 @@ public:
         result += z1 - z2 - z0;
         result <<= m2;
         result += z0;
+        // the parts are unsigned
+        result.set_neg(a.neg ^ b.neg);
         return result;
     }
 
     static Num mul(const Num &a, const Num &b){
-        size_t karatsuba_threshold = 20;
-        if (a.size() > karatsuba_threshold && b.size() > karatsuba_threshold){
+        DACIN_LP_PROFILE_NUM_TIMED(MUL, std::max(a.size(), b.size()));
+        const size_t threshold = karatsuba_threshold();
+        if (a.size() > threshold && b.size() > threshold){
             return mul_karatsuba(a, b);
         }
         return mul_long(a, b);
@@ -337,6 +490,7 @@ public:
     }
 
     Num& operator >>= (size_t n_bits){
+        DACIN_LP_PROFILE_NUM(SHIFT, size());
         if (n_bits == 0) return *this;
         size_t n_words = n_bits / word_bits();
         if (n_words >= size()){
@@ -362,6 +516,7 @@ public:
     }
 
     Num& operator <<= (size_t n_bits){
+        DACIN_LP_PROFILE_NUM(SHIFT, size());
         if (n_bits == 0) return *this;
         size_t n_words = n_bits / word_bits();
         n_bits %= word_bits();
@@ -386,6 +541,7 @@ public:
     }
 
     static void div_mod(const Num &numerator, Num denominator, Num &quotient, Num &remainder){
+        DACIN_LP_PROFILE_NUM_TIMED(DIV, numerator.size());
         quotient = 0;
         remainder = numerator;
         if (cmp_abs(remainder, denominator) >= 0){
@@ -471,11 +627,13 @@ public:
     }
 
     static Num add(const Num &a, const Num &b){
+        DACIN_LP_PROFILE_NUM(ADD, std::max(a.size(), b.size()));
         Num result = add_signed(a, a.neg, b, b.neg);
         return result;
     }
 
     static Num sub(const Num &a, const Num &b){
+        DACIN_LP_PROFILE_NUM(SUB, std::max(a.size(), b.size()));
         Num result = add_signed(a, a.neg, b, !b.neg);
         return result;
     }
@@ -613,6 +771,9 @@ public:
     ) const {
         if (size() == 0){
             text.push_back('0');
+        }else if (base == 10){
+            if (neg) text.push_back('-');
+            to_decimal(*this, 0, text);
         }else{
             Num tmp(*this);
             while (tmp.size() > 0){
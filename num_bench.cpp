@@ -0,0 +1,184 @@
+// micro-benchmarks for num.hpp, run with --help for the options
+#include "alloc_counter.hpp"
+#include "num.hpp"
+
+#include <bits/stdc++.h>
+
+using namespace std;
+
+mt19937_64 gen(1);
+
+Num random_num(size_t words, bool neg = false){
+    Num ret(words, 0, neg);
+    for(auto &e:ret.words) e = gen();
+    if(words) ret[words-1] |= 1;
+    return ret;
+}
+
+struct Measurement{
+    double ns;
+    double allocations;
+};
+
+// runs op until min_seconds have passed, at least once
+template<typename Op>
+Measurement measure(Op op, double min_seconds){
+    using Clock = chrono::steady_clock;
+    uint64_t runs = 0;
+    const uint64_t before = dacin::lp::allocation_count().load();
+    const auto start = Clock::now();
+    double elapsed = 0;
+    do {
+        op();
+        ++runs;
+        elapsed = chrono::duration<double>(Clock::now() - start).count();
+    } while(elapsed < min_seconds);
+    return Measurement{1e9 * elapsed / runs, double(dacin::lp::allocation_count().load() - before) / runs};
+}
+
+// the operation on operands of the given size, returns a callable that runs it once
+using Kernel = function<function<void()>(size_t)>;
+
+// keeps results alive so the work is not optimized away
+volatile size_t sink;
+
+const vector<pair<string, Kernel> > kernels = {
+    {"add", [](size_t n){
+        auto a = make_shared<Num>(random_num(n)), b = make_shared<Num>(random_num(n));
+        return [a, b](){ sink = (*a + *b).size(); };
+    }},
+    {"sub", [](size_t n){
+        auto a = make_shared<Num>(random_num(n)), b = make_shared<Num>(random_num(n, true));
+        return [a, b](){ sink = (*a - *b).size(); };
+    }},
+    {"mul", [](size_t n){
+        auto a = make_shared<Num>(random_num(n)), b = make_shared<Num>(random_num(n));
+        return [a, b](){ sink = (*a * *b).size(); };
+    }},
+    {"addmul_long", [](size_t n){
+        auto a = make_shared<Num>(random_num(n)), b = make_shared<Num>(random_num(n)), out = make_shared<Num>(random_num(2*n+1));
+        return [a, b, out](){ Num::addmul_long(*out, *a, *b); sink = out->size(); };
+    }},
+    {"div_mod", [](size_t n){
+        auto a = make_shared<Num>(random_num(2*n)), b = make_shared<Num>(random_num(n));
+        return [a, b](){ Num q, r; Num::div_mod(*a, *b, q, r); sink = q.size(); };
+    }},
+    {"gcd", [](size_t n){
+        auto a = make_shared<Num>(random_num(n)), b = make_shared<Num>(random_num(n));
+        return [a, b](){ sink = Num::gcd(*a, *b).size(); };
+    }},
+    {"print", [](size_t n){
+        auto a = make_shared<Num>(random_num(n));
+        return [a](){ vector<char> text; a->print(text); sink = text.size(); };
+    }},
+    {"parse", [](size_t n){
+        vector<char> text;
+        random_num(n).print(text);
+        auto digits = make_shared<string>(text.data());
+        return [digits](){ sink = Num::from_decimal(digits->data(), digits->data() + digits->size()).size(); };
+    }},
+};
+
+Kernel const& find_kernel(string const&name){
+    for(auto const&e:kernels) if(e.first == name) return e.second;
+    throw invalid_argument("unknown kernel " + name);
+}
+
+vector<size_t> size_sweep(size_t max_words){
+    vector<size_t> ret;
+    for(size_t n=1;n<=max_words;n = n < 4 ? n+1 : n*2) ret.push_back(n);
+    if(ret.back() != max_words) ret.push_back(max_words);
+    return ret;
+}
+
+// total time of mul over sizes where the karatsuba threshold matters
+double mul_cost(size_t threshold, double min_seconds){
+    Num::karatsuba_threshold() = threshold;
+    double ret = 0;
+    for(size_t n : {24, 48, 96, 192, 384}) ret += measure(find_kernel("mul")(n), min_seconds).ns / n;
+    return ret;
+}
+// total time of decimal printing and parsing over a few large sizes
+double decimal_cost(size_t threshold, double min_seconds){
+    Num::decimal_threshold() = threshold;
+    double ret = 0;
+    for(size_t n : {256, 1024, 4096}){
+        ret += measure(find_kernel("print")(n), min_seconds).ns / n;
+        ret += measure(find_kernel("parse")(n), min_seconds).ns / n;
+    }
+    return ret;
+}
+template<typename Cost>
+size_t tune(string const&name, vector<size_t> const&candidates, Cost cost, double min_seconds){
+    size_t best = candidates[0];
+    double best_cost = numeric_limits<double>::infinity();
+    for(auto t:candidates){
+        const double c = cost(t, min_seconds);
+        cerr << name << " " << t << ": " << c << "\n";
+        if(c < best_cost){
+            best_cost = c;
+            best = t;
+        }
+    }
+    return best;
+}
+
+int main(int argc, char **argv){
+    size_t max_words = 10000;
+    double min_seconds = 0.05, max_seconds = 1;
+    bool tune_mode = false;
+    string only, config_file;
+    for(int i=1;i<argc;++i){
+        const string arg = argv[i];
+        auto value = [&]() -> string {
+            if(i+1 == argc) throw invalid_argument("missing value for " + arg);
+            return argv[++i];
+        };
+        if(arg == "--max-words") max_words = stoul(value());
+        else if(arg == "--min-time") min_seconds = stod(value());
+        else if(arg == "--max-time") max_seconds = stod(value());
+        else if(arg == "--kernel") only = value();
+        else if(arg == "--tune") tune_mode = true;
+        else if(arg == "--write") config_file = value();
+        else {
+            cerr << "usage: num_bench [--max-words 10000] [--min-time 0.05] [--max-time 1] [--kernel name] [--tune [--write num_config.hpp]]\n"
+                 << "  prints ns/op and allocations/op for each kernel and operand size in words,\n"
+                 << "  a kernel stops at the first size whose single run takes longer than max-time\n"
+                 << "  --tune picks the karatsuba and decimal thresholds for this machine and writes them as a config header\n";
+            return arg == "--help" ? 0 : 2;
+        }
+    }
+    if(tune_mode){
+        const size_t karatsuba = tune("karatsuba_threshold", {8, 12, 16, 20, 24, 32, 48, 64}, mul_cost, min_seconds);
+        Num::karatsuba_threshold() = karatsuba;
+        // fills the cache of powers of ten before timing
+        find_kernel("print")(4096)();
+        const size_t decimal = tune("decimal_threshold", {8, 16, 32, 64, 128, 256}, decimal_cost, min_seconds);
+        ostringstream config;
+        config << "#ifndef NUM_CONFIG_HPP\n"
+               << "#define NUM_CONFIG_HPP\n"
+               << "// crossover thresholds of num.hpp, regenerate with num_bench --tune --write num_config.hpp\n\n"
+               << "// operands with more words than this are multiplied with karatsuba\n"
+               << "#ifndef DACIN_NUM_KARATSUBA_THRESHOLD\n"
+               << "#define DACIN_NUM_KARATSUBA_THRESHOLD " << karatsuba << "\n"
+               << "#endif\n\n"
+               << "// numbers with at most this many words are converted to decimal chunk by chunk\n"
+               << "#ifndef DACIN_NUM_DECIMAL_THRESHOLD\n"
+               << "#define DACIN_NUM_DECIMAL_THRESHOLD " << decimal << "\n"
+               << "#endif\n\n"
+               << "#endif // NUM_CONFIG_HPP\n";
+        if(config_file.empty()) cout << config.str();
+        else ofstream(config_file) << config.str();
+        return 0;
+    }
+    cout << "kernel\twords\tns_per_op\tallocations_per_op\n";
+    for(auto const&kernel:kernels){
+        if(!only.empty() && kernel.first != only) continue;
+        for(size_t n:size_sweep(max_words)){
+            const Measurement m = measure(kernel.second(n), min_seconds);
+            cout << kernel.first << "\t" << n << "\t" << m.ns << "\t" << m.allocations << endl;
+            if(m.ns * 1e-9 > max_seconds) break;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,15 @@
+#ifndef NUM_CONFIG_HPP
+#define NUM_CONFIG_HPP
+// crossover thresholds of num.hpp, regenerate with num_bench --tune --write num_config.hpp
+
+// operands with more words than this are multiplied with karatsuba
+#ifndef DACIN_NUM_KARATSUBA_THRESHOLD
+#define DACIN_NUM_KARATSUBA_THRESHOLD 20
+#endif
+
+// numbers with at most this many words are converted to decimal chunk by chunk
+#ifndef DACIN_NUM_DECIMAL_THRESHOLD
+#define DACIN_NUM_DECIMAL_THRESHOLD 32
+#endif
+
+#endif // NUM_CONFIG_HPP
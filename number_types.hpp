@@ -0,0 +1,442 @@
+#ifndef NUMBER_TYPES_HPP
+#define NUMBER_TYPES_HPP
+
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "num.hpp"
+
+#if defined(DACIN_LP_USE_GMP) && defined(__has_include)
+#if __has_include(<gmpxx.h>) && __has_include(<gmp.h>)
+#include <gmpxx.h>
+#define DACIN_LP_HAS_GMP
+#endif
+#endif
+
+namespace dacin{ namespace lp{
+
+    /*
+     * Integer types for the solvers.
+     * The solvers are templates over an integer type Int with the interface of Num:
+     *   construction from int and from a decimal string, + - * / % and their assignments,
+     *   unary -, comparisons, sign(), to_double(), size() (in 64 bit words), bitlength(),
+     *   the static functions abs, gcd, cmp and addmul_long(out, a, b) (out += a*b), and operator<<.
+     * Division truncates towards 0 and x % 0 == x, as for Num.
+     *
+     * Besides Num there are the fixed width types Int64, Int128 and Int256 that never allocate.
+     * They are meant for lps whose coefficients are known to stay small and
+     * throw std::overflow_error instead of wrapping around.
+     * Gmp_Int wraps mpz_class if compiled with -DDACIN_LP_USE_GMP and gmp is installed.
+     */
+
+    // two's complement integer with Words 64 bit words, the primitives report overflow instead of wrapping around
+    template<size_t Words>
+    class Wide_Int{
+    public:
+        using word = uint64_t;
+        static constexpr size_t bits = 64*Words;
+
+        Wide_Int() : w{} {}
+        Wide_Int(int64_t x){
+            w.fill(x < 0 ? ~word(0) : 0);
+            w[0] = word(x);
+        }
+
+        bool negative() const { return w[Words-1] >> 63; }
+        bool is_zero() const {
+            for(auto const&e:w) if(e) return false;
+            return true;
+        }
+        explicit operator double() const {
+            const Wide_Int m = magnitude(*this);
+            double ret = 0;
+            for(size_t i=Words;i-->0;) ret = ret * 18446744073709551616.0 + double(m.w[i]);
+            return negative() ? -ret : ret;
+        }
+        // bitlength of the absolute value
+        size_t bitlength() const {
+            const Wide_Int m = magnitude(*this);
+            for(size_t i=Words;i-->0;){
+                if(m.w[i]) return 64*i + 64 - __builtin_clzll(m.w[i]);
+            }
+            return 0;
+        }
+
+        // r = a + b, true on overflow, r may alias a or b
+        static bool add(Wide_Int const&a, Wide_Int const&b, Wide_Int &r){
+            Wide_Int s;
+            word carry = 0;
+            for(size_t i=0;i<Words;++i){
+                const word t = a.w[i] + carry;
+                carry = t < carry;
+                s.w[i] = t + b.w[i];
+                carry += s.w[i] < t;
+            }
+            const bool overflow = a.negative() == b.negative() && s.negative() != a.negative();
+            r = s;
+            return overflow;
+        }
+        static bool sub(Wide_Int const&a, Wide_Int const&b, Wide_Int &r){
+            Wide_Int s;
+            word borrow = 0;
+            for(size_t i=0;i<Words;++i){
+                const word t = a.w[i] - borrow;
+                borrow = a.w[i] < borrow;
+                s.w[i] = t - b.w[i];
+                borrow += t < b.w[i];
+            }
+            const bool overflow = a.negative() != b.negative() && s.negative() != a.negative();
+            r = s;
+            return overflow;
+        }
+        static bool neg(Wide_Int const&a, Wide_Int &r){
+            const bool was_negative = a.negative();
+            r = negate(a);
+            return was_negative && r.negative();
+        }
+        static bool mul(Wide_Int const&a, Wide_Int const&b, Wide_Int &r){
+            const Wide_Int ma = magnitude(a), mb = magnitude(b);
+            std::array<word, 2*Words> p{};
+            for(size_t i=0;i<Words;++i){
+                if(!ma.w[i]) continue;
+                word carry = 0;
+                for(size_t j=0;j<Words;++j){
+                    const unsigned __int128 t = (unsigned __int128)ma.w[i] * mb.w[j] + p[i+j] + carry;
+                    p[i+j] = word(t);
+                    carry = word(t >> 64);
+                }
+                p[i+Words] = carry;
+            }
+            for(size_t i=Words;i<2*Words;++i) if(p[i]) return true;
+            Wide_Int m;
+            for(size_t i=0;i<Words;++i) m.w[i] = p[i];
+            return from_magnitude(m, a.negative() != b.negative(), r);
+        }
+        // truncating division, x / 0 == 0 and x % 0 == x
+        static bool div_mod(Wide_Int const&a, Wide_Int const&b, Wide_Int &q, Wide_Int &r){
+            if(b.is_zero()){
+                r = a;
+                q = Wide_Int();
+                return false;
+            }
+            const Wide_Int ma = magnitude(a), mb = magnitude(b);
+            Wide_Int mq, mr;
+            size_t top = Words;
+            while(top > 1 && !mb.w[top-1]) --top;
+            if(top == 1){
+                unsigned __int128 rem = 0;
+                for(size_t i=Words;i-->0;){
+                    const unsigned __int128 t = (rem << 64) | ma.w[i];
+                    mq.w[i] = word(t / mb.w[0]);
+                    rem = t % mb.w[0];
+                }
+                mr.w[0] = word(rem);
+            } else {
+                // bit by bit shift and subtract for divisors of more than one word
+                for(size_t i=bits;i-->0;){
+                    shift_left_one(mr);
+                    mr.w[0] |= (ma.w[i/64] >> (i%64)) & 1;
+                    if(!less_unsigned(mr, mb)){
+                        sub(mr, mb, mr);
+                        mq.w[i/64] |= word(1) << (i%64);
+                    }
+                }
+            }
+            const bool a_negative = a.negative();
+            const bool overflow = from_magnitude(mq, a_negative != b.negative(), q);
+            from_magnitude(mr, a_negative, r);
+            return overflow;
+        }
+
+        friend bool operator==(Wide_Int const&a, Wide_Int const&b){ return a.w == b.w; }
+        friend bool operator!=(Wide_Int const&a, Wide_Int const&b){ return a.w != b.w; }
+        friend bool operator<(Wide_Int const&a, Wide_Int const&b){
+            if(a.negative() != b.negative()) return a.negative();
+            return less_unsigned(a, b);
+        }
+
+    private:
+        static Wide_Int negate(Wide_Int const&a){
+            Wide_Int r;
+            word carry = 1;
+            for(size_t i=0;i<Words;++i){
+                r.w[i] = ~a.w[i] + carry;
+                carry = carry && !r.w[i];
+            }
+            return r;
+        }
+        // absolute value as an unsigned number, exact for the most negative value too
+        static Wide_Int magnitude(Wide_Int const&a){
+            return a.negative() ? negate(a) : a;
+        }
+        static bool from_magnitude(Wide_Int const&m, bool negative, Wide_Int &r){
+            r = negative ? negate(m) : m;
+            // the magnitude must be below 2^(bits-1), or equal to it for negative results
+            return m.negative() && !(negative && r == m);
+        }
+        static bool less_unsigned(Wide_Int const&a, Wide_Int const&b){
+            for(size_t i=Words;i-->0;){
+                if(a.w[i] != b.w[i]) return a.w[i] < b.w[i];
+            }
+            return false;
+        }
+        static void shift_left_one(Wide_Int &a){
+            for(size_t i=Words;i-->1;) a.w[i] = (a.w[i] << 1) | (a.w[i-1] >> 63);
+            a.w[0] <<= 1;
+        }
+        std::array<word, Words> w;
+    };
+
+    namespace detail{
+        // overflow checked primitives of the representations of Fixed_Int, true on overflow
+        template<typename T>
+        struct Fixed_Ops;
+        template<typename T>
+        struct Builtin_Fixed_Ops{
+            static bool add(T a, T b, T &r){ return __builtin_add_overflow(a, b, &r); }
+            static bool sub(T a, T b, T &r){ return __builtin_sub_overflow(a, b, &r); }
+            static bool neg(T a, T &r){ return __builtin_sub_overflow(T(0), a, &r); }
+            static bool mul(T a, T b, T &r){ return __builtin_mul_overflow(a, b, &r); }
+            static bool div_mod(T a, T b, T &q, T &r){
+                if(b == 0){
+                    r = a;
+                    q = 0;
+                    return false;
+                }
+                if(b == -1){
+                    r = 0;
+                    return neg(a, q);
+                }
+                q = a / b;
+                r = a % b;
+                return false;
+            }
+            static bool is_zero(T a){ return a == 0; }
+            static double to_double(T a){ return double(a); }
+        };
+        template<>
+        struct Fixed_Ops<int64_t> : Builtin_Fixed_Ops<int64_t>{
+            static size_t bitlength(int64_t a){
+                const uint64_t m = a < 0 ? -uint64_t(a) : uint64_t(a);
+                return m ? 64 - __builtin_clzll(m) : 0;
+            }
+        };
+        template<>
+        struct Fixed_Ops<__int128> : Builtin_Fixed_Ops<__int128>{
+            static size_t bitlength(__int128 a){
+                const unsigned __int128 m = a < 0 ? -(unsigned __int128)a : (unsigned __int128)a;
+                const uint64_t hi = uint64_t(m >> 64), lo = uint64_t(m);
+                return hi ? 128 - __builtin_clzll(hi) : lo ? 64 - __builtin_clzll(lo) : 0;
+            }
+        };
+        template<size_t Words>
+        struct Fixed_Ops<Wide_Int<Words> >{
+            using T = Wide_Int<Words>;
+            static bool add(T const&a, T const&b, T &r){ return T::add(a, b, r); }
+            static bool sub(T const&a, T const&b, T &r){ return T::sub(a, b, r); }
+            static bool neg(T const&a, T &r){ return T::neg(a, r); }
+            static bool mul(T const&a, T const&b, T &r){ return T::mul(a, b, r); }
+            static bool div_mod(T const&a, T const&b, T &q, T &r){ return T::div_mod(a, b, q, r); }
+            static bool is_zero(T const&a){ return a.is_zero(); }
+            static double to_double(T const&a){ return double(a); }
+            static size_t bitlength(T const&a){ return a.bitlength(); }
+        };
+    }
+
+    // the interface of Num on top of a fixed width representation T, throws std::overflow_error on overflow
+    template<typename T>
+    class Fixed_Int{
+        using Ops = detail::Fixed_Ops<T>;
+    public:
+        Fixed_Int() : v(0) {}
+        Fixed_Int(int x) : v(x) {}
+        Fixed_Int(const char *c) : v(0) {
+            const bool negative = *c == '-';
+            if(negative) ++c;
+            const Fixed_Int ten(10);
+            for(;*c >= '0' && *c <= '9';++c){
+                *this *= ten;
+                // negative numbers are accumulated as such, so that the most negative value can be read
+                if(negative) *this -= Fixed_Int(*c - '0');
+                else *this += Fixed_Int(*c - '0');
+            }
+        }
+
+        T const& value() const { return v; }
+
+        int sign() const { return Ops::is_zero(v) ? 0 : v < T(0) ? -1 : 1; }
+        double to_double() const { return Ops::to_double(v); }
+        size_t bitlength() const { return Ops::bitlength(v); }
+        size_t size() const { return (bitlength() + 63) / 64; }
+
+        static Fixed_Int abs(Fixed_Int const&x){ return x.sign() < 0 ? -x : x; }
+        static Fixed_Int gcd(Fixed_Int const&a0, Fixed_Int const&b0){
+            Fixed_Int a = abs(a0), b = abs(b0);
+            while(b.sign()){
+                Fixed_Int r = a % b;
+                a = b;
+                b = r;
+            }
+            return a;
+        }
+        static int cmp(Fixed_Int const&a, Fixed_Int const&b){
+            return a.v < b.v ? -1 : b.v < a.v ? 1 : 0;
+        }
+        static void addmul_long(Fixed_Int &out, Fixed_Int const&a, Fixed_Int const&b){
+            out += a * b;
+        }
+
+        Fixed_Int& operator+=(Fixed_Int const&o){ check(Ops::add(v, o.v, v)); return *this; }
+        Fixed_Int& operator-=(Fixed_Int const&o){ check(Ops::sub(v, o.v, v)); return *this; }
+        Fixed_Int& operator*=(Fixed_Int const&o){ check(Ops::mul(v, o.v, v)); return *this; }
+        Fixed_Int& operator/=(Fixed_Int const&o){
+            T r;
+            check(Ops::div_mod(v, o.v, v, r));
+            return *this;
+        }
+        Fixed_Int& operator%=(Fixed_Int const&o){
+            T q;
+            Ops::div_mod(v, o.v, q, v);
+            return *this;
+        }
+        Fixed_Int operator+(Fixed_Int const&o) const { Fixed_Int ret(*this); return ret += o; }
+        Fixed_Int operator-(Fixed_Int const&o) const { Fixed_Int ret(*this); return ret -= o; }
+        Fixed_Int operator*(Fixed_Int const&o) const { Fixed_Int ret(*this); return ret *= o; }
+        Fixed_Int operator/(Fixed_Int const&o) const { Fixed_Int ret(*this); return ret /= o; }
+        Fixed_Int operator%(Fixed_Int const&o) const { Fixed_Int ret(*this); return ret %= o; }
+        Fixed_Int operator-() const {
+            Fixed_Int ret;
+            check(Ops::neg(v, ret.v));
+            return ret;
+        }
+
+        bool operator==(Fixed_Int const&o) const { return v == o.v; }
+        bool operator!=(Fixed_Int const&o) const { return v != o.v; }
+        bool operator<(Fixed_Int const&o) const { return v < o.v; }
+        bool operator>(Fixed_Int const&o) const { return o.v < v; }
+        bool operator<=(Fixed_Int const&o) const { return !(o.v < v); }
+        bool operator>=(Fixed_Int const&o) const { return !(v < o.v); }
+
+        friend std::ostream& operator<<(std::ostream&o, Fixed_Int const&x){
+            // digits from the remainders, which have the sign of x
+            std::string digits;
+            Fixed_Int rest = x;
+            const Fixed_Int ten(10);
+            do {
+                Fixed_Int q = rest / ten;
+                digits.push_back('0' + std::abs((rest - q * ten).to_int()));
+                rest = q;
+            } while(rest.sign());
+            if(x.sign() < 0) digits.push_back('-');
+            return o << std::string(digits.rbegin(), digits.rend());
+        }
+
+    private:
+        static void check(bool overflow){
+            if(overflow) throw std::overflow_error("fixed width integer overflow");
+        }
+        // only for values of small magnitude
+        int to_int() const { return int(to_double()); }
+        T v;
+    };
+
+    using Int64 = Fixed_Int<int64_t>;
+    using Int128 = Fixed_Int<__int128>;
+    using Int256 = Fixed_Int<Wide_Int<4> >;
+
+#ifdef DACIN_LP_HAS_GMP
+    // the interface of Num on top of mpz_class
+    class Gmp_Int{
+    public:
+        Gmp_Int() : v(0) {}
+        Gmp_Int(int x) : v(x) {}
+        Gmp_Int(const char *c) : v(c, 10) {}
+        explicit Gmp_Int(mpz_class v_) : v(std::move(v_)) {}
+
+        mpz_class const& value() const { return v; }
+
+        int sign() const { return sgn(v); }
+        double to_double() const { return v.get_d(); }
+        size_t bitlength() const { return sign() ? mpz_sizeinbase(v.get_mpz_t(), 2) : 0; }
+        size_t size() const { return (bitlength() + 63) / 64; }
+
+        static Gmp_Int abs(Gmp_Int const&x){ return Gmp_Int(mpz_class(::abs(x.v))); }
+        static Gmp_Int gcd(Gmp_Int const&a, Gmp_Int const&b){ return Gmp_Int(mpz_class(::gcd(a.v, b.v))); }
+        static int cmp(Gmp_Int const&a, Gmp_Int const&b){
+            const int c = ::cmp(a.v, b.v);
+            return c < 0 ? -1 : c > 0 ? 1 : 0;
+        }
+        static void addmul_long(Gmp_Int &out, Gmp_Int const&a, Gmp_Int const&b){
+            mpz_addmul(out.v.get_mpz_t(), a.v.get_mpz_t(), b.v.get_mpz_t());
+        }
+
+        Gmp_Int& operator+=(Gmp_Int const&o){ v += o.v; return *this; }
+        Gmp_Int& operator-=(Gmp_Int const&o){ v -= o.v; return *this; }
+        Gmp_Int& operator*=(Gmp_Int const&o){ v *= o.v; return *this; }
+        Gmp_Int& operator/=(Gmp_Int const&o){
+            if(o.sign()) v /= o.v;
+            else v = 0;
+            return *this;
+        }
+        Gmp_Int& operator%=(Gmp_Int const&o){
+            if(o.sign()) v %= o.v;
+            return *this;
+        }
+        Gmp_Int operator+(Gmp_Int const&o) const { Gmp_Int ret(*this); return ret += o; }
+        Gmp_Int operator-(Gmp_Int const&o) const { Gmp_Int ret(*this); return ret -= o; }
+        Gmp_Int operator*(Gmp_Int const&o) const { Gmp_Int ret(*this); return ret *= o; }
+        Gmp_Int operator/(Gmp_Int const&o) const { Gmp_Int ret(*this); return ret /= o; }
+        Gmp_Int operator%(Gmp_Int const&o) const { Gmp_Int ret(*this); return ret %= o; }
+        Gmp_Int operator-() const { return Gmp_Int(mpz_class(-v)); }
+
+        bool operator==(Gmp_Int const&o) const { return v == o.v; }
+        bool operator!=(Gmp_Int const&o) const { return v != o.v; }
+        bool operator<(Gmp_Int const&o) const { return v < o.v; }
+        bool operator>(Gmp_Int const&o) const { return v > o.v; }
+        bool operator<=(Gmp_Int const&o) const { return v <= o.v; }
+        bool operator>=(Gmp_Int const&o) const { return v >= o.v; }
+
+        friend std::ostream& operator<<(std::ostream&o, Gmp_Int const&x){
+            return o << x.v;
+        }
+    private:
+        mpz_class v;
+    };
+#endif // DACIN_LP_HAS_GMP
+
+    // converts between integer types through the decimal representation
+    template<typename To, typename From>
+    To convert_number(From const&x){
+        std::ostringstream o;
+        o << x;
+        return To(o.str().c_str());
+    }
+    // from Num through its words, 16 bits at a time so that only small ints are converted
+    template<typename To>
+    To convert_number(Num const&x){
+        To ret(0);
+        const To base(1 << 16);
+        for(size_t i=x.size();i-->0;){
+            for(int k=3;k>=0;--k){
+                ret *= base;
+                ret += To(int((x[i] >> (16*k)) & 0xffff));
+            }
+        }
+        return x.neg ? -ret : ret;
+    }
+    template<typename To, typename From>
+    std::vector<To> convert_numbers(std::vector<From> const&v){
+        std::vector<To> ret;
+        ret.reserve(v.size());
+        for(auto const&e:v) ret.push_back(convert_number<To>(e));
+        return ret;
+    }
+
+} }
+#endif // NUMBER_TYPES_HPP
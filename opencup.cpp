@@ -1,5 +1,5 @@
 // problem B "Basirovich Maxim" from gp of moscow 2019
-#include "clarkson.hpp"
+#include "portfolio.hpp"
 
 #include <bits/stdc++.h>
 using namespace std;
@@ -86,7 +86,8 @@ signed main()
         }
         b.emplace_back(0);
     }
-    auto res = dacin::lp::solve_clarkson_seidel(dacin::lp::Lp_Instance(move(A), move(b), move(c))); // 255 ms
+    auto res = dacin::lp::solve_auto(dacin::lp::Lp_Instance(move(A), move(b), move(c))); // 95 ms
+    //auto res = dacin::lp::solve_clarkson_seidel(dacin::lp::Lp_Instance(move(A), move(b), move(c))); // 255 ms
     //auto res = dacin::lp::solve_clarkson_simplex(dacin::lp::Lp_Instance(move(A), move(b), move(c))); // 2.5s
     assert(res.is_bounded());
     if(!res.is_feasible()){
@@ -0,0 +1,216 @@
+#ifndef PORTFOLIO_HPP
+#define PORTFOLIO_HPP
+
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "bounded_simplex.hpp"
+#include "clarkson.hpp"
+#include "fixed_width.hpp"
+#include "interior_point.hpp"
+#include "lp_instance.hpp"
+#include "lp_result.hpp"
+#include "seidel.hpp"
+#include "simplex.hpp"
+#include "solve_context.hpp"
+#include "util.hpp"
+
+namespace dacin{ namespace lp{
+
+    enum class Solver_Type{
+        SEIDEL, CLARKSON_SEIDEL, CLARKSON_SIMPLEX, SIMPLEX, BOUNDED_SIMPLEX, INTERIOR_POINT
+    };
+
+    std::string solver_name(Solver_Type solver){
+        switch(solver){
+            case Solver_Type::SEIDEL: return "seidel";
+            case Solver_Type::CLARKSON_SEIDEL: return "clarkson_seidel";
+            case Solver_Type::CLARKSON_SIMPLEX: return "clarkson_simplex";
+            case Solver_Type::SIMPLEX: return "simplex";
+            case Solver_Type::BOUNDED_SIMPLEX: return "bounded_simplex";
+            case Solver_Type::INTERIOR_POINT: return "interior_point";
+        }
+        return "unknown";
+    }
+
+    // the features of an lp the cost model looks at
+    struct Lp_Shape{
+        int n = 0, d = 0;
+        // largest bitlength of a coefficient of A or c
+        size_t input_bits = 1;
+        // fraction of nonzero coefficients of A, without the constant column
+        double density = 1;
+    };
+
+    Lp_Shape analyze_shape(Lp_Instance const&lp){
+        Lp_Shape ret;
+        ret.n = lp.n();
+        ret.d = lp.d();
+        ret.input_bits = analyze_width(lp).input_bits;
+        size_t nonzeros = 0;
+        for(auto const&e:lp.get_A()){
+            for(int j=0;j<lp.d();++j) nonzeros += e[j].sign() != 0;
+        }
+        if(lp.n() && lp.d()) ret.density = double(nonzeros) / (double(lp.n()) * lp.d());
+        return ret;
+    }
+
+    namespace detail{
+        /*
+         * Estimated running times in seconds. The forms follow the analysis of each algorithm, the constants are
+         * fitted to the running times of all solvers on the lps of generators.hpp with n up to 10^5 and d up to 20
+         * (coefficients of up to 23 bits). They rank the solvers, for a single lp they are often off by a factor of 3.
+         * Each solver was timed once per generator, n in {10^2, ..., 10^5} and d in {2, 3, 4, 6, 8, 12, 20},
+         * with rng seeded by 1 and skipping the larger n once a solver took over a second.
+         * The constants minimize the squared log ratio of estimate and time. Measured on one core of an Intel Xeon
+         * (Linux, g++ 12.2 -O2), on other machines the absolute times differ but the ranking should hold.
+         */
+        // seidel is linear in n, its dependence on d is far below the d! of the analysis for these n
+        double seidel_cost(double m, int d){
+            return 5.6e-8 * m * std::pow(4.0, d);
+        }
+        // O(d) pivots of O(m d) operations on numbers of O(d) words
+        double simplex_cost(double m, int d){
+            return 1.33e-6 * m * d * d * d;
+        }
+        double clarkson_cost(Lp_Shape const&shape, double (*backend_cost)(double, int)){
+            const Clarkson_Policy policy;
+            const int d = shape.d;
+            const double n = shape.n;
+            // violation scan of one row
+            const double scan = 3.2e-7 * (shape.density * d + 1);
+            // O(d log n) rounds on samples of sample_1 d^2 rows, far fewer than the bound of the analysis
+            auto clarkson_1 = [&](double m){
+                const double sample = policy.sample_1 * d * d;
+                if(m <= sample) return backend_cost(m, d);
+                return (d * std::log(m / sample) / 32 + 1) * (backend_cost(sample, d) + scan * m);
+            };
+            if(n <= policy.base_2 * d * d) return clarkson_1(n);
+            // O(d) rounds on samples of d sqrt(n) rows plus the kept violators
+            return (2 + d / 8.0) * (clarkson_1(std::min(n, 3 * d * std::sqrt(n))) + scan * n);
+        }
+        double interior_point_cost(Lp_Shape const&shape){
+            const double d = shape.d;
+            // iterations with a pass over A and the normal equations, then d^2 modular solves of d rows
+            return 3.6e-7 * shape.n * (d + 4) + 1e-8 * std::pow(d, 4) * (1 + shape.input_bits / 64.0);
+        }
+
+        Lp_Result auto_seidel(Lp_Instance lp){ return solve_seidel(move(lp)); }
+        Lp_Result auto_clarkson_seidel(Lp_Instance lp){ return solve_clarkson_seidel(lp); }
+        Lp_Result auto_clarkson_simplex(Lp_Instance lp){ return solve_clarkson_simplex(lp); }
+        Lp_Result auto_simplex(Lp_Instance lp){ return solve_simplex(move(lp)); }
+        Lp_Result auto_bounded_simplex(Lp_Instance lp){ return solve_bounded_simplex(lp); }
+        // the exact solvers as backends, the interior point method has none
+        Backend exact_backend(Solver_Type solver){
+            switch(solver){
+                case Solver_Type::SEIDEL: return auto_seidel;
+                case Solver_Type::CLARKSON_SEIDEL: return auto_clarkson_seidel;
+                case Solver_Type::CLARKSON_SIMPLEX: return auto_clarkson_simplex;
+                case Solver_Type::SIMPLEX: return auto_simplex;
+                case Solver_Type::BOUNDED_SIMPLEX: return auto_bounded_simplex;
+                case Solver_Type::INTERIOR_POINT: break;
+            }
+            return nullptr;
+        }
+    }
+
+    // estimated seconds of solver on an lp of the given shape
+    double estimate_cost(Solver_Type solver, Lp_Shape const&shape){
+        // the exact solvers compute with numbers a few times longer than the input
+        const double words = std::max(1.0, shape.input_bits / 32.0);
+        switch(solver){
+            case Solver_Type::SEIDEL: return words * detail::seidel_cost(shape.n, shape.d);
+            case Solver_Type::CLARKSON_SEIDEL: return words * detail::clarkson_cost(shape, detail::seidel_cost);
+            case Solver_Type::CLARKSON_SIMPLEX: return words * detail::clarkson_cost(shape, detail::simplex_cost);
+            case Solver_Type::SIMPLEX: return words * detail::simplex_cost(shape.n, shape.d);
+            case Solver_Type::BOUNDED_SIMPLEX: return words * 0.75 * detail::simplex_cost(shape.n, shape.d);
+            case Solver_Type::INTERIOR_POINT:
+                return shape.n < shape.d || shape.d == 0 ? INFINITY : detail::interior_point_cost(shape);
+        }
+        return INFINITY;
+    }
+
+    // the solver with the lowest estimate, with_interior_point = false restricts the choice to the exact solvers
+    Solver_Type choose_solver(Lp_Shape const&shape, bool with_interior_point = true){
+        Solver_Type ret = Solver_Type::SEIDEL;
+        for(Solver_Type s : {Solver_Type::CLARKSON_SEIDEL, Solver_Type::CLARKSON_SIMPLEX, Solver_Type::SIMPLEX, Solver_Type::BOUNDED_SIMPLEX, Solver_Type::INTERIOR_POINT}){
+            if(s == Solver_Type::INTERIOR_POINT && !with_interior_point) continue;
+            if(estimate_cost(s, shape) < estimate_cost(ret, shape)) ret = s;
+        }
+        return ret;
+    }
+
+    /*
+     * Solves lp with the given solver. The interior point method falls back to the exact solver
+     * with the lowest estimate if its crossover fails, which happens on very degenerate lps.
+     */
+    Lp_Result solve_with(Solver_Type solver, Lp_Instance const&lp){
+        if(solver != Solver_Type::INTERIOR_POINT) return detail::exact_backend(solver)(lp);
+        Interior_Point_Options options;
+        options.fallback = detail::exact_backend(choose_solver(analyze_shape(lp), false));
+        return solve_interior_point(lp, options);
+    }
+
+    /*
+     * Solves lp with the solver that choose_solver picks for its shape, see estimate_cost.
+     * If chosen is not null, it receives that solver.
+     */
+    Lp_Result solve_auto(Lp_Instance const&lp, Solver_Type *chosen = nullptr){
+        const Solver_Type solver = choose_solver(analyze_shape(lp));
+        if(chosen) *chosen = solver;
+        return solve_with(solver, lp);
+    }
+
+    /*
+     * Runs solvers a and b on two threads and returns the first answer (a status other than ERROR
+     * and CANCELLED), the other solver is then cancelled. If neither answers, the result is ERROR.
+     * The deadline and cancel() of context stop both, the result is then CANCELLED.
+     * The solvers run under contexts with context as parent, seeded with the seed of context and
+     * the seed + 1 if it has one. The progress callback of context is not called.
+     * The loser stops at its next checkpoint, so the return waits for up to one simplex pivot,
+     * 16 seidel calls, one clarkson violation scan or one interior point iteration of it.
+     */
+    Lp_Result solve_race(Solve_Context &context, Lp_Instance const&lp, Solver_Type a, Solver_Type b){
+        if(context.check_deadline()) return Lp_Result(Lp_Status::CANCELLED, {}, {}, Fraction());
+        const Solver_Type solvers[2] = {a, b};
+        Solve_Context racers[2];
+        Lp_Result results[2];
+        int winner = -1, finished = 0;
+        std::mutex mutex;
+        std::condition_variable done;
+        vector<std::thread> threads;
+        const size_t stall_limit = simplex_stall_limit();
+        for(int k=0;k<2;++k){
+            racers[k].set_parent(context);
+            if(context.has_seed()) racers[k].set_seed(context.get_seed() + k);
+            threads.emplace_back([&, k]{
+                simplex_stall_limit() = stall_limit;
+                Lp_Result res = solve_with_context(racers[k], lp, [&](Lp_Instance const&lp_k){ return solve_with(solvers[k], lp_k); });
+                std::lock_guard<std::mutex> lock(mutex);
+                results[k] = move(res);
+                const Lp_Status status = results[k].get_status();
+                if(winner == -1 && status != Lp_Status::ERROR && status != Lp_Status::CANCELLED){
+                    winner = k;
+                    racers[1-k].cancel();
+                }
+                ++finished;
+                done.notify_one();
+            });
+        }
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            done.wait(lock, [&]{ return winner != -1 || finished == 2; });
+        }
+        for(auto &e:threads) e.join();
+        // both racers ran past the deadline or were cancelled by context, or context was cancelled after the win
+        if(context.check_deadline()) return Lp_Result(Lp_Status::CANCELLED, {}, {}, Fraction());
+        if(winner == -1) return Lp_Result();
+        return move(results[winner]);
+    }
+
+} }
+#endif // PORTFOLIO_HPP
@@ -0,0 +1,215 @@
+#ifndef PRESOLVE_HPP
+#define PRESOLVE_HPP
+
+#include "clarkson.hpp"
+#include "lp_instance.hpp"
+#include "lp_result.hpp"
+#include "num.hpp"
+#include "util.hpp"
+
+namespace dacin{ namespace lp{
+
+    /*
+     * Result of presolve: an lp with the same feasible region and objective.
+     * Row i of get_lp() is the original constraint get_kept()[i] divided by get_divisor()[i] > 0 (its primitive form).
+     * Every removed constraint is implied by the kept constraint get_implied_by()[j]
+     * or, if that is -1, trivially satisfied or implied by the variable bounds given by the kept rows.
+     */
+    class Presolved_Lp{
+    public:
+        Presolved_Lp(Lp_Instance lp_, vector<int> kept_, vector<Num> divisor_, vector<int> removed_, vector<int> implied_by_) : lp(move(lp_)), kept(move(kept_)), divisor(move(divisor_)), removed(move(removed_)), implied_by(move(implied_by_)) {}
+
+        Lp_Instance const& get_lp() const { return lp; }
+        vector<int> const& get_kept() const { return kept; }
+        vector<Num> const& get_divisor() const { return divisor; }
+        vector<int> const& get_removed() const { return removed; }
+        vector<int> const& get_implied_by() const { return implied_by; }
+
+        // turns a result of get_lp() into a result of the original lp: the basis is renumbered by get_kept()
+        // and the dual or farkas multipliers are divided by the divisors of their rows
+        Lp_Result map_result(Lp_Result res) const {
+            if(res.get_status() == Lp_Status::ERROR || res.get_status() == Lp_Status::CANCELLED) return res;
+            vector<int> const&basis = res.get_basis();
+            const bool optimal = res.is_feasible() && res.is_bounded();
+            vector<Num> y = optimal ? res.get_dual() : res.get_farkas();
+            if(!basis.empty() && y.size() == basis.size() + optimal){
+                // y[k] / divisor[basis[k]] over the common denominator L
+                Num L(1);
+                for(int k : basis) L = L / Num::gcd(L, divisor[k]) * divisor[k];
+                for(size_t k=0;k<basis.size();++k) y[k] *= L / divisor[basis[k]];
+                if(optimal){
+                    y.back() *= L;
+                    res.set_dual(move(y));
+                } else {
+                    res.set_farkas(move(y));
+                }
+            }
+            res.map_basis(kept);
+            res.reduce_all();
+            return res;
+        }
+    private:
+        Lp_Instance lp;
+        vector<int> kept;
+        vector<Num> divisor;
+        vector<int> removed, implied_by;
+    };
+
+    namespace detail{
+        // p/q with q > 0, or infinite if q == 0
+        struct Bound{
+            Num p, q;
+            bool finite() const { return q.sign() != 0; }
+            // p/q < o.p/o.q
+            bool operator<(Bound const&o) const { return Num::cmp(p*o.q, o.p*q) < 0; }
+        };
+        // derives bounds on the variables from constraints with a single nonzero coefficient
+        void get_bounds(vector<vector<Num> > const&A, const int d, vector<Bound> &lower, vector<Bound> &upper){
+            lower.assign(d, Bound{Num(0), Num(0)});
+            upper.assign(d, Bound{Num(0), Num(0)});
+            for(auto const&e:A){
+                int j = -1;
+                for(int k=0;k<d;++k){
+                    if(e[k].sign() != 0){
+                        if(j != -1){ j = -2; break; }
+                        j = k;
+                    }
+                }
+                if(j < 0) continue;
+                // e[j] * x_j <= -e[d]
+                if(e[j].sign() > 0){
+                    Bound b{-e[d], e[j]};
+                    if(!upper[j].finite() || b < upper[j]) upper[j] = move(b);
+                } else {
+                    Bound b{e[d], -e[j]};
+                    if(!lower[j].finite() || lower[j] < b) lower[j] = move(b);
+                }
+            }
+        }
+        // true if row can't be violated within the bounds
+        bool redundant_by_bounds(vector<Num> const&row, vector<Bound> const&lower, vector<Bound> const&upper, vector<double> const&lower_d, vector<double> const&upper_d){
+            const int d = row.size()-1;
+            int nonzeros = 0;
+            double activity = 0;
+            for(int j=0;j<d;++j){
+                const int sign = row[j].sign();
+                if(sign == 0) continue;
+                ++nonzeros;
+                Bound const&b = sign > 0 ? upper[j] : lower[j];
+                if(!b.finite()) return false;
+                activity += row[j].to_double() * (sign > 0 ? upper_d[j] : lower_d[j]);
+            }
+            // bound rows are never redundant by their own bound
+            if(nonzeros <= 1) return false;
+            // floating point filter, only rows that look redundant are checked exactly
+            const double rhs = -row[d].to_double();
+            if(activity > rhs + 1e-9 * (std::fabs(activity) + std::fabs(rhs) + 1)) return false;
+            Num num(0), den(1);
+            for(int j=0;j<d;++j){
+                const int sign = row[j].sign();
+                if(sign == 0) continue;
+                Bound const&b = sign > 0 ? upper[j] : lower[j];
+                num = num * b.q + row[j] * b.p * den;
+                den *= b.q;
+            }
+            return num <= -row[d] * den;
+        }
+    }
+
+    /*
+     * Removes constraints that can never be tight:
+     * - rows with zero normal that are trivially satisfied,
+     * - duplicates and rows dominated by a parallel row (after scaling to primitive form),
+     * - if bound_filter is set, rows that are implied by the variable bounds given by
+     *   single-variable rows, found by a floating point filter and verified exactly.
+     * Kept rows are scaled to primitive integer form.
+     */
+    Presolved_Lp presolve(Lp_Instance const&lp, bool bound_filter = false){
+        const int n = lp.n(), d = lp.d();
+        auto const&A = lp.get_A();
+        vector<int> removed, implied_by;
+        vector<vector<Num> > normal(n);
+        vector<Num> scale(n);
+        vector<int> order;
+        for(int i=0;i<n;++i){
+            normal[i].assign(A[i].begin(), A[i].end()-1);
+            Num g(0);
+            for(auto const&e:normal[i]) g = Num::gcd(g, e);
+            g.set_neg(false);
+            if(g.sign() == 0){
+                if(A[i].back().sign() <= 0){
+                    removed.push_back(i);
+                    implied_by.push_back(-1);
+                    continue;
+                }
+                // infeasible row, keep it
+                g = Num(1);
+            }
+            for(auto &e:normal[i]) e /= g;
+            scale[i] = move(g);
+            order.push_back(i);
+        }
+        // group parallel rows, in every group keep the row with the smallest right hand side -A[i][d]/scale[i]
+        std::stable_sort(order.begin(), order.end(), [&normal](int i, int j){ return normal[i] < normal[j]; });
+        vector<int> kept;
+        for(size_t l=0, r=0;l<order.size();l=r){
+            int best = order[l];
+            for(r=l+1;r<order.size() && normal[order[r]] == normal[best];++r){
+                const int i = order[r];
+                // -A[i][d]/scale[i] < -A[best][d]/scale[best]
+                if(Num::cmp(A[i][d] * scale[best], A[best][d] * scale[i]) > 0) best = i;
+            }
+            kept.push_back(best);
+            for(size_t k=l;k<r;++k) if(order[k] != best){
+                removed.push_back(order[k]);
+                implied_by.push_back(best);
+            }
+        }
+        std::sort(kept.begin(), kept.end());
+        normal.clear();
+        vector<vector<Num> > A_new;
+        vector<Num> divisor;
+        for(auto const&e:kept){
+            A_new.push_back(reduced(A[e]));
+            // kept rows are nonzero
+            int j = 0;
+            while(A[e][j].sign() == 0) ++j;
+            divisor.push_back(A[e][j] / A_new.back()[j]);
+        }
+        if(bound_filter){
+            vector<detail::Bound> lower, upper;
+            detail::get_bounds(A_new, d, lower, upper);
+            vector<double> lower_d(d), upper_d(d);
+            for(int j=0;j<d;++j){
+                if(lower[j].finite()) lower_d[j] = lower[j].p.to_double() / lower[j].q.to_double();
+                if(upper[j].finite()) upper_d[j] = upper[j].p.to_double() / upper[j].q.to_double();
+            }
+            size_t m = 0;
+            for(size_t i=0;i<kept.size();++i){
+                if(detail::redundant_by_bounds(A_new[i], lower, upper, lower_d, upper_d)){
+                    removed.push_back(kept[i]);
+                    implied_by.push_back(-1);
+                } else {
+                    if(m != i){
+                        kept[m] = kept[i];
+                        divisor[m] = move(divisor[i]);
+                        A_new[m] = move(A_new[i]);
+                    }
+                    ++m;
+                }
+            }
+            kept.resize(m);
+            divisor.resize(m);
+            A_new.resize(m);
+        }
+        return Presolved_Lp(Lp_Instance(move(A_new), lp.get_c()), move(kept), move(divisor), move(removed), move(implied_by));
+    }
+
+    // the certificates of the result refer to the rows of lp
+    Lp_Result solve_presolved(Lp_Instance const&lp, Backend backend, bool bound_filter = false){
+        const Presolved_Lp pre = presolve(lp, bound_filter);
+        return pre.map_result(solve_clarkson(pre.get_lp(), backend));
+    }
+
+} }
+#endif // PRESOLVE_HPP
@@ -0,0 +1,186 @@
+#ifndef PROFILE_HPP
+#define PROFILE_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+namespace dacin{ namespace lp{
+
+    /*
+     * Counters for the hot paths of Num and the solvers.
+     * They are only updated if compiled with -DDACIN_LP_PROFILE, otherwise the
+     * DACIN_LP_PROFILE_* macros expand to nothing and the report stays empty.
+     * Counters are per thread, call reset_profile() before and get_profile() after a solve
+     * to get the report of that solve.
+     */
+    enum class Num_Op{
+        ADD, SUB, MUL, DIV, SHIFT, CMP, COUNT
+    };
+    enum class Solver_Event{
+        SIMPLEX_PIVOT, SEIDEL_CALL, CLARKSON_1_ITERATION, CLARKSON_2_ITERATION, VIOLATION_SCAN, INTERIOR_POINT_ITERATION, COUNT
+    };
+
+    struct Profile{
+        // size class k holds operands with at most 2^k words, the last one everything larger
+        static constexpr int size_classes = 8;
+        static constexpr int num_ops = int(Num_Op::COUNT), events = int(Solver_Event::COUNT);
+        // operations inside a multiplication or division are not counted
+        uint64_t num_count[num_ops][size_classes] = {};
+        // only MUL and DIV are timed
+        double num_seconds[num_ops][size_classes] = {};
+        uint64_t event_count[events] = {};
+        // only SIMPLEX_PIVOT and VIOLATION_SCAN are timed
+        double event_seconds[events] = {};
+        // seidel calls by the dimension of the lp
+        std::vector<uint64_t> seidel_calls;
+        // rows checked in violation scans
+        uint64_t scanned_rows = 0;
+
+        static int size_class(size_t words){
+            int k = 0;
+            while(k+1 < size_classes && (size_t(1) << k) < words) ++k;
+            return k;
+        }
+    };
+
+    const char* to_string(Num_Op op){
+        static const char *names[] = {"add", "sub", "mul", "div", "shift", "cmp"};
+        return names[int(op)];
+    }
+    const char* to_string(Solver_Event event){
+        static const char *names[] = {"simplex_pivot", "seidel_call", "clarkson_1_iteration", "clarkson_2_iteration", "violation_scan", "interior_point_iteration"};
+        return names[int(event)];
+    }
+
+    Profile& profile_counters(){
+        static thread_local Profile profile;
+        return profile;
+    }
+    void reset_profile(){
+        profile_counters() = Profile();
+    }
+    Profile get_profile(){
+        return profile_counters();
+    }
+
+    namespace detail{
+        // adds the time of its lifetime to seconds
+        class Profile_Timer{
+        public:
+            explicit Profile_Timer(double &seconds_) : seconds(seconds_), start(std::chrono::steady_clock::now()) {}
+            ~Profile_Timer(){
+                seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            }
+        private:
+            double &seconds;
+            std::chrono::steady_clock::time_point start;
+        };
+        // nesting depth of timed Num operations, e.g. the parts of a karatsuba multiplication
+        int& profile_num_depth(){
+            static thread_local int depth = 0;
+            return depth;
+        }
+        void profile_num(Num_Op op, size_t words){
+            if(!profile_num_depth()) ++profile_counters().num_count[int(op)][Profile::size_class(words)];
+        }
+        class Profile_Num_Timer{
+        public:
+            Profile_Num_Timer(Num_Op op, size_t words) : outer(!profile_num_depth()++) {
+                if(!outer) return;
+                const int k = Profile::size_class(words);
+                ++profile_counters().num_count[int(op)][k];
+                seconds = &profile_counters().num_seconds[int(op)][k];
+                start = std::chrono::steady_clock::now();
+            }
+            ~Profile_Num_Timer(){
+                --profile_num_depth();
+                if(outer) *seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            }
+        private:
+            bool outer;
+            double *seconds = nullptr;
+            std::chrono::steady_clock::time_point start;
+        };
+        void profile_seidel_call(size_t d){
+            auto &calls = profile_counters().seidel_calls;
+            if(calls.size() <= d) calls.resize(d+1);
+            ++calls[d];
+            ++profile_counters().event_count[int(Solver_Event::SEIDEL_CALL)];
+        }
+        void profile_scan(uint64_t rows, double seconds){
+            Profile &p = profile_counters();
+            ++p.event_count[int(Solver_Event::VIOLATION_SCAN)];
+            p.event_seconds[int(Solver_Event::VIOLATION_SCAN)] += seconds;
+            p.scanned_rows += rows;
+        }
+    }
+
+    void write_profile_json(std::ostream &o, Profile const&p){
+        o << "{\"num\":{";
+        for(int op=0;op<Profile::num_ops;++op){
+            o << (op ? "," : "") << "\"" << to_string(Num_Op(op)) << "\":{\"count\":[";
+            for(int k=0;k<Profile::size_classes;++k) o << (k ? "," : "") << p.num_count[op][k];
+            o << "],\"seconds\":[";
+            for(int k=0;k<Profile::size_classes;++k) o << (k ? "," : "") << p.num_seconds[op][k];
+            o << "]}";
+        }
+        o << "},\"events\":{";
+        for(int e=0;e<Profile::events;++e){
+            o << (e ? "," : "") << "\"" << to_string(Solver_Event(e)) << "\":{\"count\":" << p.event_count[e] << ",\"seconds\":" << p.event_seconds[e] << "}";
+        }
+        o << "},\"seidel_calls\":[";
+        for(size_t d=0;d<p.seidel_calls.size();++d) o << (d ? "," : "") << p.seidel_calls[d];
+        o << "],\"scanned_rows\":" << p.scanned_rows << "}";
+    }
+    std::ostream& operator<<(std::ostream &o, Profile const&p){
+        for(int op=0;op<Profile::num_ops;++op){
+            o << to_string(Num_Op(op)) << ":";
+            for(int k=0;k<Profile::size_classes;++k){
+                if(!p.num_count[op][k]) continue;
+                o << " [<=" << (size_t(1) << k) << (k+1 == Profile::size_classes ? "+" : "") << " words] " << p.num_count[op][k];
+                if(p.num_seconds[op][k] > 0) o << " (" << p.num_seconds[op][k] << "s)";
+            }
+            o << "\n";
+        }
+        for(int e=0;e<Profile::events;++e){
+            o << to_string(Solver_Event(e)) << ": " << p.event_count[e];
+            if(p.event_seconds[e] > 0) o << " (" << p.event_seconds[e] << "s)";
+            o << "\n";
+        }
+        o << "seidel calls by dimension:";
+        for(auto const&e:p.seidel_calls) o << " " << e;
+        return o << "\nscanned rows: " << p.scanned_rows << "\n";
+    }
+
+} }
+
+#define DACIN_LP_PROFILE_CONCAT_(a, b) a##b
+#define DACIN_LP_PROFILE_CONCAT(a, b) DACIN_LP_PROFILE_CONCAT_(a, b)
+#ifdef DACIN_LP_PROFILE
+// counts a Num operation on operands of up to words words
+#define DACIN_LP_PROFILE_NUM(op, words) ::dacin::lp::detail::profile_num(::dacin::lp::Num_Op::op, words)
+// counts a Num operation and times the rest of the scope
+#define DACIN_LP_PROFILE_NUM_TIMED(op, words) \
+    ::dacin::lp::detail::Profile_Num_Timer DACIN_LP_PROFILE_CONCAT(profile_timer_, __LINE__)(::dacin::lp::Num_Op::op, words)
+#define DACIN_LP_PROFILE_EVENT(event) \
+    ++::dacin::lp::profile_counters().event_count[int(::dacin::lp::Solver_Event::event)]
+// counts an event and times the rest of the scope
+#define DACIN_LP_PROFILE_EVENT_TIMED(event) \
+    DACIN_LP_PROFILE_EVENT(event); \
+    ::dacin::lp::detail::Profile_Timer DACIN_LP_PROFILE_CONCAT(profile_timer_, __LINE__)( \
+        ::dacin::lp::profile_counters().event_seconds[int(::dacin::lp::Solver_Event::event)])
+#define DACIN_LP_PROFILE_SEIDEL_CALL(d) ::dacin::lp::detail::profile_seidel_call(d)
+// a violation scan over rows constraints that took seconds
+#define DACIN_LP_PROFILE_SCAN(rows, seconds) ::dacin::lp::detail::profile_scan(rows, seconds)
+#else
+#define DACIN_LP_PROFILE_NUM(op, words) ((void)0)
+#define DACIN_LP_PROFILE_NUM_TIMED(op, words) ((void)0)
+#define DACIN_LP_PROFILE_EVENT(event) ((void)0)
+#define DACIN_LP_PROFILE_EVENT_TIMED(event) ((void)0)
+#define DACIN_LP_PROFILE_SEIDEL_CALL(d) ((void)0)
+#define DACIN_LP_PROFILE_SCAN(rows, seconds) ((void)0)
+#endif // DACIN_LP_PROFILE
+
+#endif // PROFILE_HPP
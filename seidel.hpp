@@ -5,12 +5,15 @@
 #include "lp_instance.hpp"
 #include "lp_result.hpp"
 #include "num.hpp"
+#include "profile.hpp"
+#include "solve_context.hpp"
 
 namespace dacin{ namespace lp{
     namespace detail{
 
-        std::pair<std::vector<Num>, int> make_projection(std::vector<Num> constraint){
-            const int k = std::find_if(constraint.begin(), constraint.end(), [](Num const&x){ return x.sign() != 0; }) - constraint.begin();
+        template<typename Int>
+        std::pair<std::vector<Int>, int> make_projection(std::vector<Int> constraint){
+            const int k = std::find_if(constraint.begin(), constraint.end(), [](Int const&x){ return x.sign() != 0; }) - constraint.begin();
             assert(k+1 < (int)constraint.size());
             if(constraint[k].sign() == -1){
                 for(auto &e:constraint){
@@ -19,20 +22,22 @@ namespace dacin{ namespace lp{
             }
             return std::make_pair(std::move(constraint), k);
         }
-        std::vector<Num> project_down(std::vector<Num> const&vec, std::vector<Num> const&plane, int const i){
+        template<typename Int>
+        std::vector<Int> project_down(std::vector<Int> const&vec, std::vector<Int> const&plane, int const i){
             const size_t n = vec.size();
             assert(n <= plane.size() && plane.size() <= n+1);
             assert(plane[i].sign() > 0);
-            std::vector<Num> ret(n-1);
+            std::vector<Int> ret(n-1);
             for(int j=0;j<i;++j) ret[j] = vec[j]*plane[i] - vec[i]*plane[j];
             for(int j=i+1;j<(int)n;++j) ret[j-1] = vec[j]*plane[i] - vec[i]*plane[j];
             return ret;
         }
-        std::vector<Num> project_up(std::vector<Num> const&vec, std::vector<Num> const&plane, int const i){
+        template<typename Int>
+        std::vector<Int> project_up(std::vector<Int> const&vec, std::vector<Int> const&plane, int const i){
             const size_t n = vec.size();
             assert(plane.size() == n+1);
             assert(plane[i].sign() > 0);
-            std::vector<Num> ret(n+1);
+            std::vector<Int> ret(n+1);
             for(int j=0;j<i;++j){
                 ret[j] = vec[j] * plane[i];
                 ret[i] -= vec[j] * plane[j];
@@ -44,29 +49,77 @@ namespace dacin{ namespace lp{
             return ret;
         }
 
-        Lp_Result seidel_rec(Lp_Instance lp, const bool move_to_front, const size_t front_size = 0){
+        /*
+         * Lifts the certificate of the lp projected onto plane (the constraint A[i], negated if flipped)
+         * to the lp of this level. rows of the projected lp are the rows A[ids[t]].
+         * With sum_t y_t * proj(A[ids[t]]) == D * proj(c), where proj(v) = v*plane[k] - v[k]*plane,
+         * the multipliers plane[k]*y_t together with D*c[k] - sum_t y_t*A[ids[t]][k] for the plane
+         * combine to D*plane[k] * c. Farkas multipliers lift the same way with D*c == 0.
+         */
+        template<typename Int>
+        void lift_certificate(Basic_Lp_Result<Int> &res, std::vector<std::vector<Int> > const&A, std::vector<Int> const&c, vector<int> ids, std::vector<Int> const&plane, const int k, const bool flipped, const int i){
+            vector<int> basis = res.get_basis();
+            const bool optimal = res.is_feasible() && res.is_bounded();
+            vector<Int> y = optimal ? res.get_dual() : res.get_farkas();
+            if(res.is_feasible() && !optimal){
+                y.clear();
+            } else {
+                const size_t b = basis.size();
+                assert(y.size() == b + optimal);
+                Int plane_y = optimal ? y.back() * c[k] : Int(0);
+                for(size_t t=0;t<b;++t){
+                    plane_y -= y[t] * A[ids[basis[t]]][k];
+                    y[t] *= plane[k];
+                }
+                if(flipped) plane_y = -plane_y;
+                if(optimal){
+                    y.back() *= plane[k];
+                    y.insert(y.begin()+b, move(plane_y));
+                } else {
+                    y.push_back(move(plane_y));
+                }
+            }
+            basis.push_back(ids.size());
+            ids.push_back(i);
+            if(optimal) res.set_dual(move(y));
+            else res.set_farkas(move(y));
+            res.set_basis(move(basis));
+            res.map_basis(ids);
+        }
+
+        template<typename Int>
+        Basic_Lp_Result<Int> seidel_rec(Basic_Lp_Instance<Int> lp, const bool move_to_front, const size_t front_size = 0){
+            using Lp_Instance = Basic_Lp_Instance<Int>;
+            using Lp_Result = Basic_Lp_Result<Int>;
+            using Fraction = Basic_Fraction<Int>;
             const int n = lp.n(), d = lp.d();
+            DACIN_LP_PROFILE_SEIDEL_CALL(d);
+            solve_checkpoint(Solver_Event::SEIDEL_CALL);
             if(d == 0){
-                Lp_Result ret(Lp_Status::OPTIMAL, {Num(1)}, {Num(0)}, Fraction(0));
-                for(auto const&e:lp.get_A()){
-                    if(ret.violates(e)) return Lp_Result::infeasible_result();
+                Lp_Result ret(Lp_Status::OPTIMAL, {Int(1)}, {Int(0)}, Fraction(0));
+                for(int i=0;i<n;++i){
+                    if(ret.violates(lp.get_A()[i])) return Lp_Result::infeasible_result({i}, {Int(1)});
                 }
+                ret.set_dual({Int(1)});
                 return ret;
             }
             auto get_base_result = [&lp, &n, &d](){
-                std::vector<Num> x(d+1), ray(d+1);
-                x.back() = Num(1);
+                std::vector<Int> x(d+1), ray(d+1);
+                x.back() = Int(1);
                 for(int i=0;i<d;++i){
-                    ray[i] = Num(lp.get_c()[i].sign());
+                    ray[i] = Int(lp.get_c()[i].sign());
                 }
                 bool obj_unbounded = scal_affine(lp.get_c(), ray).sign() > 0;
                 Lp_Result ret(obj_unbounded ? Lp_Status::UNBOUNDED : Lp_Status::OPTIMAL, move(x), move(ray), Fraction(0));
+                if(!obj_unbounded) ret.set_dual({Int(1)}); // c == 0
                 return ret;
             };
             if(d == 1){
                 // solve in deterministic O(n)
                 Lp_Result ret = get_base_result();
-                for(auto &e:lp.get_A()){
+                int last = -1;
+                for(int i=0;i<n;++i){
+                    auto const&e = lp.get_A()[i];
                     if(ret.violates(e)){
                         switch(e[0].sign()){
                             case -1:
@@ -78,53 +131,97 @@ namespace dacin{ namespace lp{
                                 ret.set_x({-e[1], e[0]});
                                 break;
                             case 0:
-                                return Lp_Result::infeasible_result();
+                                return Lp_Result::infeasible_result({i}, {Int(1)});
                         }
+                        last = i;
                         ret.recalc_objective(lp.get_c());
                     }
                 }
-                for(auto &e:lp.get_A()){
+                for(auto const&e:lp.get_A()){
                     if(ret.violates(e)){
-                        return Lp_Result::infeasible_result();
+                        // the largest lower bound exceeds the smallest upper bound
+                        int lower = -1, upper = -1;
+                        for(int i=0;i<n;++i){
+                            auto const&f = lp.get_A()[i];
+                            if(f[0].sign() == 0) continue;
+                            // bound -f[1]/f[0], a larger f[1]/|f[0]| is tighter for both kinds
+                            int &best = f[0].sign() < 0 ? lower : upper;
+                            if(best == -1){
+                                best = i;
+                                continue;
+                            }
+                            auto const&g = lp.get_A()[best];
+                            const int cmp = Int::cmp(f[1] * Int::abs(g[0]), g[1] * Int::abs(f[0]));
+                            if(cmp > 0) best = i;
+                        }
+                        assert(lower != -1 && upper != -1);
+                        return Lp_Result::infeasible_result({lower, upper}, {Int::abs(lp.get_A()[upper][0]), Int::abs(lp.get_A()[lower][0])});
                     }
                 }
+                if(last != -1){
+                    ret.set_basis({last});
+                    Int const&c0 = lp.get_c()[0];
+                    if(c0.sign() == 0) ret.set_dual({Int(0), Int(1)});
+                    else if(ret.is_bounded()) ret.set_dual({Int::abs(c0), Int::abs(lp.get_A()[last][0])});
+                }
                 return ret;
             } else {
+                // rows are accessed in random order, certificates are renumbered at the end
+                vector<int> order(n);
+                std::iota(order.begin(), order.end(), 0);
                 {
-                    auto &A = const_cast<std::vector<std::vector<Num>>&>(lp.get_A());
-                    std::shuffle(A.begin() + std::min(front_size, A.size()), A.end(), rng);
+                    auto &A = const_cast<std::vector<std::vector<Int>>&>(lp.get_A());
+                    std::shuffle(order.begin() + std::min(front_size, A.size()), order.end(), rng);
+                    std::vector<std::vector<Int> > A_shuffled(n);
+                    for(int i=0;i<n;++i){
+                        A_shuffled[i] = std::move(A[order[i]]);
+                    }
+                    A = std::move(A_shuffled);
                 }
                 Lp_Result ret = get_base_result();
                 vector<int> moved_indices;
                 for(int i=0;i<n;++i){
                     auto const&e = lp.get_A()[i];
                     if(ret.violates(e)){
+                        if(std::all_of(e.begin(), prev(e.end()), [](Int const&x){ return x.sign() == 0; })){
+                            // 0 <= -e[d] is violated
+                            return Lp_Result::infeasible_result({order[i]}, {Int(1)});
+                        }
                         // project down, recurse, project up
                         auto projection = make_projection(e);
                         auto const plane = projection.first;
                         const int k = projection.second;
-                        std::vector<std::vector<Num> > A_sub;
+                        const bool flipped = e[k].sign() < 0;
+                        std::vector<std::vector<Int> > A_sub;
+                        vector<int> sub_ids;
                         for(auto it = moved_indices.rbegin(); it != moved_indices.rend();++it){
                             A_sub.push_back(std::move(project_down(lp.get_A()[*it], plane, k)));
+                            sub_ids.push_back(*it);
                         }
                         for(int j=0;j<i;++j){
                             A_sub.push_back(std::move(project_down(lp.get_A()[j], plane, k)));
+                            sub_ids.push_back(j);
                         }
-                        std::vector<Num> c_sub = project_down(lp.get_c(), plane, k);
+                        std::vector<Int> c_sub = project_down(lp.get_c(), plane, k);
                         Lp_Result sub_result = seidel_rec(std::move(Lp_Instance(std::move(A_sub), std::move(c_sub))), move_to_front, front_size + moved_indices.size());
-                        if(!sub_result.is_feasible()) return sub_result;
+                        lift_certificate(sub_result, lp.get_A(), lp.get_c(), move(sub_ids), plane, k, flipped, i);
+                        if(!sub_result.is_feasible()){
+                            sub_result.map_basis(order);
+                            return sub_result;
+                        }
                         ret = sub_result;
                         ret.set_x(project_up(sub_result.get_x(), plane, k));
                         ret.set_ray(project_up(sub_result.get_ray(), plane, k));
                         if(move_to_front) moved_indices.push_back(i);
                     }
                 }
+                ret.map_basis(order);
                 return ret;
             }
         }
     }
-    template<bool move_to_front = false>
-    Lp_Result solve_seidel(Lp_Instance lp){
+    template<bool move_to_front = false, typename Int = Num>
+    Basic_Lp_Result<Int> solve_seidel(Basic_Lp_Instance<Int> lp){
         auto const c = lp.get_c();
         auto res = detail::seidel_rec(std::move(lp), move_to_front);
         res.reduce_all();
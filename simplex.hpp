@@ -4,19 +4,42 @@
 #include "fraction.hpp"
 #include "lp_result.hpp"
 #include "lp_instance.hpp"
+#include "profile.hpp"
+#include "solve_context.hpp"
 #include "util.hpp"
 
 namespace dacin{ namespace lp{
+
+    // pivot counters of the simplex solves of this thread, reset them before a solve
+    struct Simplex_Stats{
+        uint64_t pivots = 0, degenerate_pivots = 0, bland_pivots = 0, bound_flips = 0;
+    };
+    Simplex_Stats& simplex_stats(){
+        static thread_local Simplex_Stats stats;
+        return stats;
+    }
+    /*
+     * After this many consecutive degenerate pivots the simplex picks the entering variable by bland's rule
+     * (the smallest index, the leaving row is already chosen by the smallest index among ties),
+     * which can't cycle, until a pivot moves the vertex again. Steepest edge alone can stall on degenerate lps.
+     * The limit is per thread, the workers of solve_clarkson_batch, solve_parallel and solve_race take it from the calling thread.
+     */
+    size_t& simplex_stall_limit(){
+        static thread_local size_t limit = 50;
+        return limit;
+    }
+
     namespace detail{
 
-        void reduce_tableau(vector<vector<Num> > &T, Num& scale){
-            Num g = scale;
+        template<typename Int>
+        void reduce_tableau(vector<vector<Int> > &T, Int& scale){
+            Int g = scale;
             for(auto const&e:T){
                 for(auto &f:e){
-                    g = Num::gcd(g, f);
+                    g = Int::gcd(g, f);
                 }
             }
-            if(g != Num(1)){
+            if(g != Int(1)){
                 scale/=g;
                 for(auto &e:T){
                     for(auto &f:e){
@@ -25,9 +48,11 @@ namespace dacin{ namespace lp{
                 }
             }
         }
-        void pivot(vector<vector<Num> > &T, Num& scale, vector<int> &basic, vector<int> &nonbasic, int const enter, int const leave){
+        template<typename Int>
+        void pivot(vector<vector<Int> > &T, Int& scale, vector<int> &basic, vector<int> &nonbasic, int const enter, int const leave){
+            DACIN_LP_PROFILE_EVENT_TIMED(SIMPLEX_PIVOT);
             const int X = T.size(), Y = T[0].size();
-            const Num Drs_abs = Num::abs(T[leave][enter]);
+            const Int Drs_abs = Int::abs(T[leave][enter]);
             const int Drs_sign = T[leave][enter].sign();
             for(int i=0;i<X;++i) if(i != leave){
                 for(int j=0;j<Y;++j) if(j != enter){
@@ -45,69 +70,309 @@ namespace dacin{ namespace lp{
             std::swap(basic[leave], nonbasic[enter]);
             reduce_tableau(T, scale);
         }
-        int run_phase(vector<vector<Num> > &T, Num&scale, vector<int> &basic, vector<int> &nonbasic, const int phase){
+        /*
+         * Bounds of the structural variables 0..d-1 of a tableau in its coordinates, slack variables are only >= 0.
+         * A nonbasic variable is at 0, so lower <= 0 <= upper for it, missing bounds are -+inf.
+         * A variable at a bound is shifted so that the bound becomes 0, a variable that decreases is negated.
+         */
+        template<typename Int>
+        struct Variable_Bounds{
+            using Fraction = Basic_Fraction<Int>;
+            vector<Fraction> lower, upper;
+            // the variable of the initial tableau is shift + v, or shift - v if negated
+            vector<Fraction> shift;
+            vector<char> negated;
+
+            explicit Variable_Bounds(int d) : lower(d, -Fraction::inf()), upper(d, Fraction::inf()), shift(d), negated(d, 0) {}
+            bool structural(int v) const { return v >= 0 && v < (int)lower.size(); }
+            bool can_increase(int v) const { return !structural(v) || upper[v].sign() > 0; }
+            bool can_decrease(int v) const { return structural(v) && lower[v].sign() < 0; }
+            void negate(int v){
+                std::swap(lower[v], upper[v]);
+                lower[v] = -lower[v];
+                upper[v] = -upper[v];
+                negated[v] ^= 1;
+            }
+            // v becomes v - b
+            void move_by(int v, Fraction const&b){
+                lower[v] -= b;
+                upper[v] -= b;
+                shift[v] += negated[v] ? -b : b;
+                lower[v].normalize();
+                upper[v].normalize();
+                shift[v].normalize();
+            }
+        };
+        template<typename Int>
+        void negate_column(vector<vector<Int> > &T, int const j){
+            for(auto &e:T) e[j] = -e[j];
+        }
+        // substitutes the nonbasic variable of column j by v + b, the tableau is multiplied by the denominator of b
+        template<typename Int>
+        void shift_column(vector<vector<Int> > &T, Int& scale, int const j, Basic_Fraction<Int> const&b){
+            const int Y = T[0].size();
+            Int const&p = b.numerator(), &q = b.denominator();
+            if(q == Int(1)){
+                for(auto &e:T) e[Y-1] -= e[j] * p;
+                return;
+            }
+            for(auto &e:T){
+                e[Y-1] = e[Y-1] * q - e[j] * p;
+                for(int k=0;k<Y-1;++k) e[k] *= q;
+            }
+            scale *= q;
+            reduce_tableau(T, scale);
+        }
+        // substitutes the basic variable of row i by v + b
+        template<typename Int>
+        void shift_row(vector<vector<Int> > &T, Int& scale, int const i, Basic_Fraction<Int> const&b){
+            const int Y = T[0].size();
+            Int const&p = b.numerator(), &q = b.denominator();
+            if(q == Int(1)){
+                T[i][Y-1] -= p * scale;
+                return;
+            }
+            for(int r=0;r<(int)T.size();++r) if(r != i){
+                for(auto &e:T[r]) e *= q;
+            }
+            for(int k=0;k<Y-1;++k) T[i][k] *= q;
+            T[i][Y-1] = T[i][Y-1] * q - p * scale;
+            scale *= q;
+        }
+        /*
+         * Compares the steepest edge slopes -t^2/n and -u^2/m of two entering candidates, both t and u are negative.
+         * Like cmp_fraction it only multiplies if the bitlengths and a double estimate don't decide.
+         */
+        template<typename Int>
+        int cmp_slope(Int const&t, Int const&n, Int const&u, Int const&m){
+            // a column without nonzero entries has slope -infinity
+            if(n.sign() == 0 || m.sign() == 0) return int(m.sign() == 0) - int(n.sign() == 0);
+            // 2^(e-2) < t^2/n < 2^(e+1) for e = 2 bitlength(t) - bitlength(n)
+            const long e_t = 2*long(t.bitlength()) - long(n.bitlength());
+            const long e_u = 2*long(u.bitlength()) - long(m.bitlength());
+            if(e_t >= e_u + 3) return -1;
+            if(e_u >= e_t + 3) return 1;
+            if(std::max(std::max(t.bitlength(), n.bitlength()), std::max(u.bitlength(), m.bitlength())) <= 960){
+                // |t|/sqrt(n) is monotone in t^2/n and can't overflow
+                const double x = std::abs(t.to_double()) / std::sqrt(n.to_double()), y = std::abs(u.to_double()) / std::sqrt(m.to_double());
+                if(std::abs(x - y) > 1e-10 * std::max(x, y)){
+                    return x > y ? -1 : 1;
+                }
+            }
+            return Int::cmp(u * u * n, t * t * m);
+        }
+        /*
+         * Ratio test with variable bounds, a basic variable can leave at its lower or its upper bound and the entering
+         * variable can reach its own upper bound first. Returns the leaving row, n for a bound flip of the entering
+         * variable or -1 if nothing limits it. bound is set to the bound at which the variable leaves.
+         */
+        template<typename Int>
+        int bounded_ratio_test(vector<vector<Int> > const&T, Int const&scale, vector<int> const&basic, vector<int> const&nonbasic, const int enter, Variable_Bounds<Int> const&bounds, Basic_Fraction<Int> const* &bound){
+            const int n = T.size()-2, d = T[0].size()-2;
+            static const Basic_Fraction<Int> zero;
+            int leave = -1;
+            bound = nullptr;
+            // ratios to a nonzero bound need temporaries, the best one is kept in the other slot
+            Int bound_num[2], bound_den[2];
+            int slot = 0;
+            Int const *best_num = nullptr, *best_den = nullptr;
+            for(int i=0;i<n;++i){
+                const int s = T[i][enter].sign();
+                if(s == 0) continue;
+                const int v = basic[i];
+                Basic_Fraction<Int> const*b = &zero;
+                if(bounds.structural(v)){
+                    b = s > 0 ? &bounds.lower[v] : &bounds.upper[v];
+                    if(b->denominator().sign() == 0) continue;
+                } else if(s < 0){
+                    continue;
+                }
+                Int const *num = &T[i][d+1], *den = &T[i][enter];
+                if(b->sign() != 0 || s < 0){
+                    // (value - b) / alpha
+                    Int const&p = b->numerator(), &q = b->denominator();
+                    bound_num[slot] = q * T[i][d+1] - p * scale;
+                    bound_den[slot] = q * T[i][enter];
+                    if(s < 0){
+                        bound_num[slot] = -bound_num[slot];
+                        bound_den[slot] = -bound_den[slot];
+                    }
+                    num = &bound_num[slot];
+                    den = &bound_den[slot];
+                }
+                int c = -1;
+                if(leave != -1) c = cmp_fraction(*num, *den, *best_num, *best_den);
+                if(c < 0 || (c == 0 && basic[i] < basic[leave])){
+                    leave = i;
+                    best_num = num;
+                    best_den = den;
+                    bound = b;
+                    if(num == &bound_num[slot]) slot ^= 1;
+                }
+            }
+            const int e = nonbasic[enter];
+            if(bounds.structural(e) && bounds.upper[e].denominator().sign() != 0){
+                auto const&upper = bounds.upper[e];
+                // a bound flip needs no pivot, so it wins ties
+                if(leave == -1 || cmp_fraction(upper.numerator(), upper.denominator(), *best_num, *best_den) <= 0){
+                    bound = &upper;
+                    return n;
+                }
+            }
+            return leave;
+        }
+        template<typename Int>
+        int run_phase(vector<vector<Int> > &T, Int&scale, vector<int> &basic, vector<int> &nonbasic, const int phase, Variable_Bounds<Int> *bounds = nullptr){
             const int n = T.size()-2, d = T[0].size()-2;
             const int x = phase==1 ? n+1 : n;
+            Simplex_Stats &stats = simplex_stats();
+            Int best_norm_sq;
+            // consecutive degenerate pivots
+            size_t stall = 0;
             for(;;){
+                solve_checkpoint(Solver_Event::SIMPLEX_PIVOT);
+                // without bounds the vertices of phase 2 are feasible
+                if(phase == 2 && !bounds) report_bound(T[n][d+1], scale, false);
                 int enter = -1;
-                // primal steepest edge with lexicographical tie breaking
-                Fraction slope = Fraction::inf();
+                // primal steepest edge with lexicographical tie breaking, bland's rule after a stall
+                const bool bland = stall >= simplex_stall_limit();
                 for(int j=0;j<=d;++j){
                     if(phase==2 && nonbasic[j] == -1) continue;
-                    Num norm_sq;
+                    // with bounds a variable can also enter by decreasing
+                    const int s = T[x][j].sign();
+                    if(s == 0) continue;
+                    if(bounds ? !(s < 0 ? bounds->can_increase(nonbasic[j]) : bounds->can_decrease(nonbasic[j])) : s > 0) continue;
+                    if(bland){
+                        if(enter == -1 || nonbasic[j] < nonbasic[enter]) enter = j;
+                        continue;
+                    }
+                    Int norm_sq;
                     for(int i=0;i<=n;++i){
                         //norm_sq += T[i][j]*T[i][j];
-                        Num::addmul_long(norm_sq, T[i][j], T[i][j]);
+                        Int::addmul_long(norm_sq, T[i][j], T[i][j]);
                     }
-                    Fraction slope_j (T[x][j] * Num::abs(T[x][j]), norm_sq);
-                    if(std::make_pair(slope_j, nonbasic[j]) < std::make_pair(slope, enter==-1 ? -1 : nonbasic[enter])){
+                    int c = -1;
+                    if(enter != -1) c = cmp_slope(T[x][j], norm_sq, T[x][enter], best_norm_sq);
+                    if(c < 0 || (c == 0 && nonbasic[j] < nonbasic[enter])){
                         enter = j;
-                        slope = move(slope_j);
+                        std::swap(best_norm_sq, norm_sq);
                     }
                 }
-                if(T[x][enter].sign() >= 0) return -1;
+                if(enter == -1) return -1;
                 int leave = -1;
-                Fraction ratio = Fraction::inf();
-                for(int i=0;i<n;++i){
-                    if(T[i][enter].sign() > 0){
-                        Fraction ratio_i = Fraction(T[i][d+1], T[i][enter]);
-                        if(std::make_pair(ratio_i, basic[i])  < std::make_pair(ratio, leave==-1 ? -1 : basic[leave])){
-                            leave = i;
-                            ratio = move(ratio_i);
+                if(bounds){
+                    if(T[x][enter].sign() > 0){
+                        negate_column(T, enter);
+                        bounds->negate(nonbasic[enter]);
+                    }
+                    Basic_Fraction<Int> const*bound;
+                    leave = bounded_ratio_test(T, scale, basic, nonbasic, enter, *bounds, bound);
+                    if(leave == -1) return enter;
+                    // the bound changes with the shift
+                    const Basic_Fraction<Int> b = *bound;
+                    if(leave == n){
+                        shift_column(T, scale, enter, b);
+                        bounds->move_by(nonbasic[enter], b);
+                        ++stats.bound_flips;
+                        stall = 0;
+                        continue;
+                    }
+                    if(b.sign() != 0){
+                        shift_row(T, scale, leave, b);
+                        bounds->move_by(basic[leave], b);
+                    }
+                } else {
+                    // minimum ratio test with lexicographical tie breaking, the ratios are T[i][d+1] / T[i][enter]
+                    for(int i=0;i<n;++i){
+                        if(T[i][enter].sign() > 0){
+                            int c = -1;
+                            if(leave != -1) c = cmp_fraction(T[i][d+1], T[i][enter], T[leave][d+1], T[leave][enter]);
+                            if(c < 0 || (c == 0 && basic[i] < basic[leave])){
+                                leave = i;
+                            }
                         }
                     }
+                    if(leave == -1) return enter;
+                }
+                // the leaving variable is at its bound, so the pivot doesn't move the vertex
+                if(T[leave][d+1].sign() == 0){
+                    ++stats.degenerate_pivots;
+                    ++stall;
+                } else {
+                    stall = 0;
                 }
-                if(leave == -1) return enter;
+                ++stats.pivots;
+                if(bland) ++stats.bland_pivots;
                 pivot(T, scale, basic, nonbasic, enter, leave);
             }
         }
-        Lp_Result tableau_simplex(vector<vector<Num> > T){
+        // the nonbasic slack variables and their reduced costs in row x give a dual certificate
+        template<typename Int>
+        void get_certificate(vector<vector<Int> > const&T, vector<int> const&nonbasic, const int x, vector<int> &basis, vector<Int> &y){
+            const int d = T[0].size()-2;
+            basis.clear();
+            y.clear();
+            for(int j=0;j<=d;++j){
+                if(nonbasic[j] >= d){
+                    basis.push_back(nonbasic[j] - d);
+                    y.push_back(T[x][j]);
+                }
+            }
+        }
+        /*
+         * Runs phase 1 with the auxiliary variable of column d and phase 2 on T.
+         * Returns -2 if the lp is infeasible (row n+1 then holds the certificate), -1 if it is optimal
+         * and the entering column of an unbounded ray otherwise.
+         */
+        template<typename Int>
+        int run_two_phase(vector<vector<Int> > &T, Int &scale, vector<int> &basic, vector<int> &nonbasic, Variable_Bounds<Int> *bounds = nullptr){
             const int n = T.size()-2, d = T[0].size()-2;
-            vector<int> basic(n); std::iota(basic.begin(), basic.end(), d);
-            vector<int> nonbasic(d+1, -1); std::iota(nonbasic.begin(), prev(nonbasic.end()), 0);
+            basic.resize(n); std::iota(basic.begin(), basic.end(), d);
+            nonbasic.assign(d+1, -1); std::iota(nonbasic.begin(), prev(nonbasic.end()), 0);
             int leave = 0;
             for(int i=1;i<n;++i){
                 if(T[i].back() < T[leave].back()) leave = i;
             }
-            Num scale(1);
+            scale = Int(1);
             if(T[leave][d+1].sign() < 0){
                 pivot(T, scale, basic, nonbasic, d, leave);
-                const int feasible_fail = run_phase(T, scale, basic, nonbasic, 1);
-                if(feasible_fail != -1){
-                    return Lp_Result::infeasible_result();
+                // the auxiliary objective is bounded by 0
+                const int feasible_fail = run_phase(T, scale, basic, nonbasic, 1, bounds);
+                assert(feasible_fail == -1);
+                (void)feasible_fail;
+                if(T[n+1][d+1].sign() < 0){
+                    // the auxiliary variable can't reach 0
+                    return -2;
                 }
                 for(int i=0;i<n;++i) if(basic[i] == -1){
-                    int enter = 0;
-                    for(int j=1;j<=d;++j){
-                        if(std::make_pair(T[i][j], nonbasic[j]) < std::make_pair(T[i][enter], nonbasic[enter])){
+                    int enter = -1;
+                    for(int j=0;j<=d;++j){
+                        if(T[i][j].sign() == 0) continue;
+                        if(enter == -1 || std::make_pair(T[i][j], nonbasic[j]) < std::make_pair(T[i][enter], nonbasic[enter])){
                             enter = j;
                         }
                     }
-                    pivot(T, scale, basic, nonbasic, enter, i);
+                    // an all zero row keeps the auxiliary variable at 0
+                    if(enter != -1) pivot(T, scale, basic, nonbasic, enter, i);
                 }
             }
-            const int bounded_fail = run_phase(T, scale, basic, nonbasic, 2);
-            vector<Num> x(d+1, 0);
+            return run_phase(T, scale, basic, nonbasic, 2, bounds);
+        }
+        template<typename Int>
+        Basic_Lp_Result<Int> tableau_simplex(vector<vector<Int> > T){
+            using Lp_Result = Basic_Lp_Result<Int>;
+            using Fraction = Basic_Fraction<Int>;
+            const int n = T.size()-2, d = T[0].size()-2;
+            vector<int> basic, nonbasic;
+            Int scale;
+            const int bounded_fail = run_two_phase(T, scale, basic, nonbasic);
+            if(bounded_fail == -2){
+                vector<int> basis;
+                vector<Int> farkas;
+                get_certificate(T, nonbasic, n+1, basis, farkas);
+                return Lp_Result::infeasible_result(move(basis), move(farkas));
+            }
+            vector<Int> x(d+1, 0);
             x.back() = scale;
             for(int i=0;i<n;++i) if(basic[i] < d){
                 x[basic[i]] = T[i].back();
@@ -115,7 +380,7 @@ namespace dacin{ namespace lp{
             if(bounded_fail != -1){
                 const int bf = bounded_fail;
                 // unbounded ray is needed for clarkson to work
-                vector<Num> ray(d+1, 0);
+                vector<Int> ray(d+1, 0);
                 ray.back() = 0;
                 for(int i=0;i<n;++i) if(basic[i] < d){
                     ray[basic[i]] = -T[i][bf];
@@ -125,14 +390,22 @@ namespace dacin{ namespace lp{
                 }
                 return Lp_Result(Lp_Status::UNBOUNDED, move(x), move(ray), Fraction::inf());
             }
-            return Lp_Result(Lp_Status::OPTIMAL, move(x), {}, Fraction(T[n].back(), scale));
+            Lp_Result ret(Lp_Status::OPTIMAL, move(x), {}, Fraction(T[n].back(), scale));
+            vector<int> basis;
+            vector<Int> dual;
+            get_certificate(T, nonbasic, n, basis, dual);
+            dual.push_back(scale);
+            ret.set_basis(move(basis));
+            ret.set_dual(move(dual));
+            return ret;
         }
     }
 
-    vector<Num> transform_back(vector<Num> const&v){
+    template<typename Int>
+    vector<Int> transform_back(vector<Int> const&v){
         assert(v.size()%2 == 1);
         const int d0 = v.size()/2;
-        vector<Num> ret(d0+1);
+        vector<Int> ret(d0+1);
         for(int i=0;i<d0;++i){
             ret[i] = v[2*i] - v[2*i+1];
         }
@@ -140,25 +413,26 @@ namespace dacin{ namespace lp{
         return ret;
     }
 
-    Lp_Result solve_simplex(Lp_Instance lp){
+    template<typename Int = Num>
+    Basic_Lp_Result<Int> solve_simplex(Basic_Lp_Instance<Int> lp){
         const int d0 = lp.d();
         const int d = 2*d0;
         const int n = lp.n();
-        vector<vector<Num> > T(n+2, vector<Num>(d+2));
+        vector<vector<Int> > T(n+2, vector<Int>(d+2));
         for(int i=0;i<n;++i){
             for(int j=0;j<d0;++j){
                 T[i][2*j] = lp.get_A()[i][j];
                 T[i][2*j+1] = -lp.get_A()[i][j];
             }
-            T[i][d] = Num(-1);
+            T[i][d] = Int(-1);
             T[i][d+1] = -lp.get_A()[i].back();
         }
         for(int j=0;j<d0;++j){
             T[n][2*j] = -lp.get_c()[j];
             T[n][2*j+1] = lp.get_c()[j];
         }
-        T[n+1][d] = Num(1);
-        Lp_Result ret = detail::tableau_simplex(move(T));
+        T[n+1][d] = Int(1);
+        Basic_Lp_Result<Int> ret = detail::tableau_simplex(move(T));
         if(ret.is_feasible()){
             ret.set_x(move(transform_back(ret.get_x())));
         }
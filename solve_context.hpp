@@ -0,0 +1,236 @@
+#ifndef SOLVE_CONTEXT_HPP
+#define SOLVE_CONTEXT_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <random>
+
+#include "lp_instance.hpp"
+#include "lp_result.hpp"
+#include "profile.hpp"
+#include "util.hpp"
+
+namespace dacin{ namespace lp{
+
+    // state of a running solve as seen by the progress callback
+    struct Solve_Progress{
+        // counts by Solver_Event: simplex iterations, seidel calls, clarkson rounds and interior point iterations
+        uint64_t events[int(Solver_Event::COUNT)] = {};
+        // bounds on the optimum found so far: the vertices of the simplex in phase 2 are feasible and give lower bounds,
+        // the optima of clarkson samples give upper bounds as a sample is a relaxation of the lp
+        double lower_bound = -INFINITY, upper_bound = INFINITY;
+        double seconds = 0;
+    };
+
+    namespace detail{
+        // thrown at a checkpoint of a cancelled solve, caught by solve_with_context
+        struct Solve_Cancelled{};
+    }
+
+    /*
+     * Deadline, cancellation and progress reporting of a solve, see solve_with_context.
+     * The solvers check the context at every simplex iteration, seidel call, clarkson round and
+     * interior point iteration, so a solve stops within one of those steps after the deadline or cancel().
+     * cancel() may be called from any thread, the callback is called from the solving thread.
+     * A context with a seed carries its own random state, the solve then doesn't depend on
+     * the thread it runs on or on earlier solves of that thread. Worker threads of the solve
+     * get random states seeded by the seed and their index, see detail::run_worker.
+     */
+    class Solve_Context{
+    public:
+        using Clock = std::chrono::steady_clock;
+        using Callback = std::function<void(Solve_Progress const&)>;
+
+        Solve_Context() : deadline(Clock::time_point::max()), cancelled(false), timed_out(false) {}
+        Solve_Context(Solve_Context const&) = delete;
+        Solve_Context& operator=(Solve_Context const&) = delete;
+
+        void set_deadline(Clock::time_point deadline_){ deadline = deadline_; }
+        void set_timeout(double seconds){
+            deadline = Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+        }
+        Clock::time_point get_deadline() const { return deadline; }
+        void cancel(){ cancelled.store(true, std::memory_order_relaxed); }
+        // set by cancel(), once the deadline has passed or if the parent is cancelled
+        bool is_cancelled() const { return cancelled.load(std::memory_order_relaxed) || (parent && parent->is_cancelled()); }
+        // makes this the context of a worker thread of a solve under parent_: it stops with parent_ and by its deadline
+        void set_parent(Solve_Context const&parent_){
+            parent = &parent_;
+            deadline = std::min(deadline, parent_.get_deadline());
+        }
+        bool is_timed_out() const { return timed_out; }
+        // callback gets the progress at most once per interval seconds
+        void set_progress_callback(Callback callback_, double interval_ = 0.1){
+            callback = move(callback_);
+            interval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(interval_));
+        }
+        Solve_Progress const& get_progress() const { return progress; }
+        // the random state of solves under this context starts from seed, it continues over consecutive solves
+        void set_seed(uint64_t seed_){
+            seed = seed_;
+            seeded = true;
+            std::seed_seq seq{uint32_t(seed), uint32_t(seed >> 32)};
+            random.seed(seq);
+        }
+        bool has_seed() const { return seeded; }
+        uint64_t get_seed() const { return seed; }
+        // the random state, used by the solve instead of rng if has_seed()
+        std::mt19937& get_random(){ return random; }
+
+        // called by solve_with_context
+        void start(){
+            progress = Solve_Progress();
+            relaxations = 0;
+            start_time = next_report = Clock::now();
+        }
+        // called by the solvers, throws detail::Solve_Cancelled once the solve should stop
+        void checkpoint(Solver_Event event){
+            const uint64_t count = ++progress.events[int(event)];
+            if(is_cancelled()) throw detail::Solve_Cancelled();
+            // seidel calls are too cheap to read the clock every time
+            if(event == Solver_Event::SEIDEL_CALL && count % 16) return;
+            const Clock::time_point now = Clock::now();
+            if(now >= deadline){
+                timed_out = true;
+                cancel();
+                throw detail::Solve_Cancelled();
+            }
+            if(callback && now >= next_report){
+                progress.seconds = std::chrono::duration<double>(now - start_time).count();
+                next_report = now + interval;
+                callback(progress);
+            }
+        }
+        // cancels the solve once the deadline has passed, true if it is cancelled
+        bool check_deadline(){
+            if(!is_cancelled() && Clock::now() >= deadline){
+                timed_out = true;
+                cancel();
+            }
+            return is_cancelled();
+        }
+        // bounds cost a conversion to double, so the solvers only report them if there is a callback
+        bool wants_bounds() const { return bool(callback); }
+        void report_lower_bound(double bound){
+            // a feasible point of a relaxation is no lower bound
+            if(relaxations == 0) progress.lower_bound = std::max(progress.lower_bound, bound);
+        }
+        void report_upper_bound(double bound){ progress.upper_bound = std::min(progress.upper_bound, bound); }
+        // number of enclosing solves of a relaxation of the lp, see detail::Relaxation_Scope
+        int relaxations = 0;
+
+    private:
+        Solve_Context const *parent = nullptr;
+        Clock::time_point deadline, start_time, next_report;
+        Clock::duration interval = std::chrono::milliseconds(100);
+        std::atomic<bool> cancelled;
+        bool timed_out;
+        Callback callback;
+        Solve_Progress progress;
+        bool seeded = false;
+        uint64_t seed = 0;
+        std::mt19937 random;
+    };
+
+    namespace detail{
+        // the context of the solve running on this thread, or null
+        Solve_Context*& current_context(){
+            static thread_local Solve_Context *context = nullptr;
+            return context;
+        }
+        void solve_checkpoint(Solver_Event event){
+            if(Solve_Context *context = current_context()) context->checkpoint(event);
+        }
+        // checks for cancellation between steps that are no solver events, e.g. the objectives of a batch
+        void solve_check(){
+            Solve_Context *context = current_context();
+            if(context && context->check_deadline()) throw Solve_Cancelled();
+        }
+        // num / den as a bound of the optimum, if anybody listens
+        template<typename Int>
+        void report_bound(Int const&num, Int const&den, const bool upper){
+            Solve_Context *context = current_context();
+            if(!context || !context->wants_bounds() || den.sign() == 0) return;
+            const double bound = num.to_double() / den.to_double();
+            if(std::isnan(bound)) return;
+            if(upper) context->report_upper_bound(bound);
+            else context->report_lower_bound(bound);
+        }
+        // installs a context for the lifetime of the scope, nested scopes restore the outer context
+        class Context_Scope{
+        public:
+            explicit Context_Scope(Solve_Context &context) : outer(current_context()) { current_context() = &context; }
+            ~Context_Scope(){ current_context() = outer; }
+        private:
+            Solve_Context *outer;
+        };
+        // marks the solves in the scope as solves of a relaxation, e.g. of a clarkson sample
+        class Relaxation_Scope{
+        public:
+            Relaxation_Scope() : context(current_context()) { if(context) ++context->relaxations; }
+            ~Relaxation_Scope(){ if(context) --context->relaxations; }
+        private:
+            Solve_Context *context;
+        };
+        // swaps the random state of a seeded context into rng for the lifetime of the scope
+        class Random_Scope{
+        public:
+            explicit Random_Scope(Solve_Context &context_) : context(context_) { swap_state(); }
+            ~Random_Scope(){ swap_state(); }
+        private:
+            void swap_state(){ if(context.has_seed()) std::swap(rng, context.get_random()); }
+            Solve_Context &context;
+        };
+    }
+
+    namespace detail{
+        /*
+         * Runs work() on worker thread index of a solve under context, which may be null.
+         * The worker gets a context of its own with context as parent, so it stops with context,
+         * and if context has a seed its random state is seeded by the seed + index.
+         * Returns false if it was cancelled.
+         */
+        template<typename Work>
+        bool run_worker(Solve_Context const*context, uint64_t index, Work work){
+            if(!context){
+                work();
+                return true;
+            }
+            Solve_Context worker;
+            worker.set_parent(*context);
+            if(context->has_seed()) worker.set_seed(context->get_seed() + index);
+            Context_Scope scope(worker);
+            Random_Scope random(worker);
+            worker.start();
+            try {
+                work();
+                return true;
+            } catch(Solve_Cancelled const&){
+                return false;
+            }
+        }
+    }
+
+    /*
+     * Calls solve(lp) under context, e.g. solve_with_context(context, lp, solve_simplex<Num>).
+     * The status is CANCELLED if the solve was cancelled or ran past the deadline, is_timed_out() tells which.
+     * Threads started by the solvers stop with context too: solve_system_modular checks it between its
+     * rounds of primes, the workers of solve_clarkson_batch and solve_parallel run under contexts with
+     * context as parent. The progress callback is only called for the calling thread.
+     */
+    template<typename Solve>
+    Lp_Result solve_with_context(Solve_Context &context, Lp_Instance const&lp, Solve solve){
+        detail::Context_Scope scope(context);
+        detail::Random_Scope random(context);
+        context.start();
+        try {
+            return solve(lp);
+        } catch(detail::Solve_Cancelled const&){
+            return Lp_Result(Lp_Status::CANCELLED, {}, {}, Fraction());
+        }
+    }
+
+} }
+#endif // SOLVE_CONTEXT_HPP
@@ -0,0 +1,221 @@
+#ifndef STREAMING_HPP
+#define STREAMING_HPP
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include "binary_format.hpp"
+#include "clarkson.hpp"
+#include "lp_instance.hpp"
+#include "lp_reader.hpp"
+#include "lp_result.hpp"
+#include "mapped_file.hpp"
+#include "num.hpp"
+#include "profile.hpp"
+#include "solve_context.hpp"
+#include "util.hpp"
+
+namespace dacin{ namespace lp{
+
+    /*
+     * Sequential access to the constraints of an lp that need not fit into memory.
+     * Rows are read in passes from row 0 to row n-1.
+     */
+    class Constraint_Source{
+    public:
+        virtual ~Constraint_Source() {}
+        virtual int64_t n() const = 0;
+        virtual int d() const = 0;
+        virtual vector<Num> const& objective() const = 0;
+        // starts a new pass at row 0
+        virtual void rewind() = 0;
+        // reads the next row of the pass, false at the end
+        virtual bool next(vector<Num> &row) = 0;
+    };
+
+    class Lp_Instance_Source : public Constraint_Source{
+    public:
+        explicit Lp_Instance_Source(Lp_Instance const&lp_) : lp(lp_) {}
+        int64_t n() const override { return lp.n(); }
+        int d() const override { return lp.d(); }
+        vector<Num> const& objective() const override { return lp.get_c(); }
+        void rewind() override { pos = 0; }
+        bool next(vector<Num> &row) override {
+            if(pos == lp.n()) return false;
+            row = lp.get_A()[pos++];
+            return true;
+        }
+    private:
+        Lp_Instance const&lp;
+        int pos = 0;
+    };
+
+    // binary file written by write_binary, read through a memory map
+    class Binary_Lp_Source : public Constraint_Source{
+    public:
+        explicit Binary_Lp_Source(std::string const&filename) : file(new Mapped_File(filename)), view(*file), c(view.objective()) {}
+        int64_t n() const override { return view.n(); }
+        int d() const override { return view.d(); }
+        vector<Num> const& objective() const override { return c; }
+        void rewind() override { pos = 0; }
+        bool next(vector<Num> &row) override {
+            if(pos == view.n()) return false;
+            view.read_row(pos++, row);
+            return true;
+        }
+    private:
+        std::unique_ptr<Mapped_File> file;
+        Binary_Lp_View view;
+        vector<Num> c;
+        int pos = 0;
+    };
+
+    // text file starting with DACIN_LP, the objective is found by skipping over the rows once
+    class Text_Lp_Source : public Constraint_Source{
+    public:
+        explicit Text_Lp_Source(std::string const&filename) : file(new Mapped_File(filename)), rows(*file), reader(rows) {
+            rows.expect("DACIN_LP");
+            n_ = rows.read_int();
+            const int64_t d = rows.read_int();
+            if(n_ < 0 || d < 0) throw std::runtime_error("invalid lp size");
+            Lp_Reader tail = rows;
+            tail.skip(n_ * (d+1));
+            c.resize(d);
+            for(auto &e:c) e = tail.read_num();
+            rewind();
+        }
+        int64_t n() const override { return n_; }
+        int d() const override { return c.size(); }
+        vector<Num> const& objective() const override { return c; }
+        void rewind() override {
+            reader = rows;
+            pos = 0;
+        }
+        bool next(vector<Num> &row) override {
+            if(pos == n_) return false;
+            row.resize(c.size()+1);
+            for(auto &e:row) e = reader.read_num();
+            ++pos;
+            return true;
+        }
+    private:
+        std::unique_ptr<Mapped_File> file;
+        Lp_Reader rows, reader;
+        int64_t n_, pos = 0;
+        vector<Num> c;
+    };
+
+    namespace detail{
+        /*
+         * clarkson_2 with the constraints read from a source.
+         * Every iteration is a single pass that checks the rows against the current result
+         * and draws the sample of the next iteration by reservoir sampling.
+         * Only the sample of d * sqrt(n) rows and up to 2 * sqrt(n) violators
+         * per successful iteration are kept in memory (with the default policy).
+         */
+        Lp_Result clarkson_2_streaming(Constraint_Source &source, Backend backend, Clarkson_Policy const&policy, Clarkson_Stats *stats){
+            const int64_t n = source.n();
+            const int d = source.d();
+            vector<Num> const&c = source.objective();
+            vector<Num> row;
+            source.rewind();
+            if(n <= policy.base_2*d*d){
+                vector<vector<Num> > A;
+                while(source.next(row)) A.push_back(row);
+                return clarkson_1(A, c, backend, policy, stats);
+            }
+            const int64_t root_n = llround(sqrt(n));
+            const int64_t keep = policy.keep_2 * root_n;
+            double scale = 1, sub_solve = 0;
+            Relaxation_Scope relaxation;
+            // constraints kept in all samples, and the sample of the current iteration
+            vector<vector<Num> > A_keep, A_sample;
+            vector<int> ids_keep, ids_sample;
+            vector<vector<Num> > violators;
+            vector<int> violator_ids;
+            Lp_Result res;
+            for(bool first = true;;first = false){
+                const int64_t k = std::min<int64_t>(n, std::max<int64_t>(d+1, llround(scale * policy.sample_2 * d * root_n)));
+                Clock::time_point start = Clock::now();
+                vector<vector<Num> > A_next;
+                vector<int> ids_next;
+                int64_t violated = 0;
+                violators.clear();
+                violator_ids.clear();
+                source.rewind();
+                for(int64_t i=0;source.next(row);++i){
+                    if(!first && res.violates(row)){
+                        ++violated;
+                        if(violated <= keep){
+                            violators.push_back(row);
+                            violator_ids.push_back(int(i));
+                        }
+                    }
+                    if(i < k){
+                        A_next.push_back(row);
+                        ids_next.push_back(int(i));
+                    } else {
+                        const int64_t j = randint<int64_t>(0, i);
+                        if(j < k){
+                            A_next[j] = row;
+                            ids_next[j] = int(i);
+                        }
+                    }
+                }
+                if(!first){
+                    const double scan = seconds_since(start);
+                    DACIN_LP_PROFILE_SCAN(n, scan);
+                    if(stats){
+                        stats->scan_seconds += scan;
+                        stats->add_violators(violated);
+                    }
+                    if(violated == 0){
+                        return res;
+                    }
+                    const bool failed = violated > keep;
+                    if(!failed){
+                        for(size_t i=0;i<violators.size();++i){
+                            A_keep.push_back(move(violators[i]));
+                            ids_keep.push_back(violator_ids[i]);
+                        }
+                    } else if(stats){
+                        ++stats->failed_rounds_2;
+                    }
+                    // the sample drawn in this pass keeps its size, the next one is adapted
+                    adapt_scale(policy, scale, failed, sub_solve, scan);
+                }
+                A_sample = A_keep;
+                ids_sample = ids_keep;
+                for(size_t i=0;i<A_next.size();++i){
+                    A_sample.push_back(move(A_next[i]));
+                    ids_sample.push_back(ids_next[i]);
+                }
+                DACIN_LP_PROFILE_EVENT(CLARKSON_2_ITERATION);
+                solve_checkpoint(Solver_Event::CLARKSON_2_ITERATION);
+                if(stats){
+                    ++stats->iterations_2;
+                    stats->last_sample = A_sample.size();
+                }
+                start = Clock::now();
+                res = clarkson_1(A_sample, c, backend, policy, stats);
+                sub_solve = seconds_since(start);
+                res.map_basis(ids_sample);
+                if(!res.is_feasible()){
+                    return res;
+                }
+            }
+        }
+    }
+
+    /*
+     * Solves an lp whose constraints are read from source in sequential passes,
+     * for constraint sets that do not fit into memory.
+     * The basis of the result refers to the row numbers of the source.
+     */
+    Lp_Result solve_clarkson_streaming(Constraint_Source &source, Backend backend, Clarkson_Policy const&policy = Clarkson_Policy(), Clarkson_Stats *stats = nullptr){
+        return detail::clarkson_2_streaming(source, backend, policy, stats);
+    }
+
+} }
+#endif // STREAMING_HPP
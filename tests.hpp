@@ -5,13 +5,29 @@
 
 #include "simplex.hpp"
 
+#include "batch.hpp"
+#include "binary_format.hpp"
+#include "bounded_simplex.hpp"
 #include "clarkson.hpp"
+#include "fixed_width.hpp"
 #include "fraction.hpp"
+#include "generators.hpp"
+#include "incremental.hpp"
+#include "interior_point.hpp"
 #include "lp_instance.hpp"
+#include "lp_reader.hpp"
 #include "lp_result.hpp"
+#include "modular.hpp"
 #include "num.hpp"
+#include "number_types.hpp"
+#include "portfolio.hpp"
+#include "presolve.hpp"
+#include "profile.hpp"
 #include "seidel.hpp"
+#include "solve_context.hpp"
+#include "streaming.hpp"
 #include "util.hpp"
+#include "verify.hpp"
 
 namespace dacin{ namespace lp{
     using namespace std;
@@ -37,18 +53,13 @@ namespace dacin{ namespace lp{
     void test_from_file(string filename, Solver solver){
         reset_seed();
         cerr << "Test  file=" << filename << ", solver=" << (uintptr_t)solver << "\n";
-        ifstream in(filename);
-        in.exceptions(ios::badbit | ios::eofbit | ios::failbit);
-        string s;
-        in >> s;
-        assert(s == "DACIN_LP");
-        Lp_Instance lp;
-        in >> lp;
-        in >> s;
-        assert(s == "SOL");
-        auto read_num = [&in, &s](Num&f){
-            in >> s;
-            f = move(Num(s.c_str()));
+        Mapped_File file(filename);
+        Lp_Reader reader(file);
+        reader.expect("DACIN_LP");
+        Lp_Instance lp = execute_timed("Read", [&reader](){ return reader.read_instance(); });
+        reader.expect("SOL");
+        auto read_num = [&reader](Num&f){
+            f = reader.read_num();
         };
         Num numer, denom;
         read_num(numer);
@@ -72,6 +83,11 @@ namespace dacin{ namespace lp{
         auto error = [&](string const& message){
             cerr << "[ERROR] " << message << "\n";
         };
+        string verify_error;
+        if(!execute_timed("Verify", verify_result, lp, sol, &verify_error)){
+            error("Verification failed: " + verify_error);
+            return;
+        }
         if(status == Lp_Status::INFEASIBLE){
             if(sol.is_feasible()){
                 error("Lp is infeasible but solver reports feasible or unbounded.");
@@ -140,7 +156,806 @@ namespace dacin{ namespace lp{
             }
         }
     }
+    void test_batch_from_file(string filename, int objectives, int threads){
+        reset_seed();
+        cerr << "Batch test  file=" << filename << ", objectives=" << objectives << ", threads=" << threads << "\n";
+        // every row also as doubled copy in front, so presolve renumbers and rescales the rows
+        Lp_Instance file_lp = read_lp_file(filename);
+        vector<vector<Num> > A;
+        for(auto const&row:file_lp.get_A()){
+            A.push_back(row);
+            for(auto &e:A.back()) e *= Num(2);
+            A.push_back(row);
+        }
+        Lp_Instance lp(move(A), file_lp.get_c());
+        vector<vector<Num> > cs(objectives, vector<Num>(lp.d()));
+        for(auto &e:cs){
+            for(auto &f:e) f = Num(uniform_int_distribution<int>(-100, 100)(rng));
+        }
+        auto sols = execute_timed("Batch", solve_clarkson_seidel_batch<false>, lp, cs, threads);
+        for(int i=0;i<objectives;++i){
+            Lp_Result sol = solve_clarkson_seidel(Lp_Instance(lp.get_A(), cs[i]));
+            if(sol.is_feasible() != sols[i].is_feasible() || (sol.is_feasible() && sol.is_bounded() != sols[i].is_bounded())){
+                cerr << "[ERROR] Batch status differs for objective " << i << "\n";
+                return;
+            }
+            if(sol.is_feasible() && sol.is_bounded() && sol.get_objective() != sols[i].get_objective()){
+                cerr << "[ERROR] Batch objective differs for objective " << i << "\n";
+                cerr << sol.get_objective() << " vs " << sols[i].get_objective() << "\n";
+                return;
+            }
+            if(!verify_result(Lp_Instance(lp.get_A(), cs[i]), sols[i])){
+                cerr << "[ERROR] Invalid batch certificate for objective " << i << "\n";
+                return;
+            }
+        }
+        cerr << "    Test Passed.\n\n";
+    }
+
+    void test_incremental_from_file(string filename){
+        reset_seed();
+        cerr << "Incremental test  file=" << filename << "\n";
+        Lp_Instance lp = read_lp_file(filename);
+        auto const&A = lp.get_A();
+        const int n = lp.n();
+        auto check = [&](Incremental_Solver &solver, string const&step){
+            Lp_Result const& sol = execute_timed(step, [&solver]() -> Lp_Result const& { return solver.solve(); });
+            Lp_Result ref = solve_clarkson_seidel(solver.get_lp());
+            if(sol.is_feasible() != ref.is_feasible() || (ref.is_feasible() && sol.is_bounded() != ref.is_bounded())){
+                cerr << "[ERROR] Incremental status differs after " << step << "\n";
+                return false;
+            }
+            if(ref.is_feasible() && ref.is_bounded() && sol.get_objective() != ref.get_objective()){
+                cerr << "[ERROR] Incremental objective differs after " << step << "\n";
+                cerr << ref.get_objective() << " vs " << sol.get_objective() << "\n";
+                return false;
+            }
+            if(!verify_result(solver.get_lp(), sol)){
+                cerr << "[ERROR] Invalid incremental certificate after " << step << "\n";
+                return false;
+            }
+            return true;
+        };
+        Incremental_Solver solver(Lp_Instance(vector<vector<Num> >(A.begin(), A.begin()+n/2), lp.get_c()));
+        if(!check(solver, "initial")) return;
+        solver.add_constraints(vector<vector<Num> >(A.begin()+n/2, A.end()-5));
+        if(!check(solver, "add")) return;
+        solver.add_constraints(vector<vector<Num> >(A.end()-5, A.end()));
+        if(!check(solver, "small add")) return;
+        solver.remove_constraints(solver.get_tight());
+        if(!check(solver, "remove tight")) return;
+        vector<Num> c = lp.get_c();
+        c[0] += Num(1);
+        solver.set_objective(c);
+        if(!check(solver, "set objective")) return;
+        // the cached result stays optimal, its basis has to follow the renumbering
+        vector<int> slack;
+        for(int i=0;i<solver.n() && slack.size() < 10;++i){
+            if(std::find(solver.get_tight().begin(), solver.get_tight().end(), i) == solver.get_tight().end()) slack.push_back(i);
+        }
+        solver.remove_constraints(slack);
+        if(!check(solver, "remove slack")) return;
+        cerr << "    Test Passed.\n\n";
+    }
+
+    void test_presolve_from_file(string filename){
+        cerr << "Presolve test  file=" << filename << "\n";
+        Lp_Instance lp = read_lp_file(filename);
+        // add duplicates, scaled and dominated copies and a box that makes one row redundant
+        vector<vector<Num> > A = lp.get_A();
+        const int n = A.size(), d = lp.d();
+        for(int i=0;i<n;i+=10){
+            A.push_back(lp.get_A()[i]);
+            vector<Num> row = lp.get_A()[i];
+            for(auto &e:row) e *= Num(3);
+            A.push_back(row);
+            row.back() -= Num(1);
+            A.push_back(row);
+        }
+        for(int j=0;j<d;++j){
+            vector<Num> row(d+1);
+            row[j] = Num(1);
+            row[d] = Num(-1000000000);
+            A.push_back(row);
+            row[j] = Num(-1);
+            A.push_back(row);
+        }
+        vector<Num> loose(d+1, Num(1));
+        loose[d] = Num(-1000000000) * Num(d);
+        A.push_back(loose);
+        Lp_Instance big(A, lp.get_c());
+        Presolved_Lp pre = execute_timed("Presolve", presolve, big, true);
+        if(pre.get_lp().n() + pre.get_removed().size() != A.size() || pre.get_lp().n() > n + 2*d){
+            cerr << "[ERROR] Presolve kept " << pre.get_lp().n() << " of " << A.size() << " rows\n";
+            return;
+        }
+        Lp_Result sol = solve_clarkson_seidel(pre.get_lp());
+        Lp_Result ref = solve_clarkson_seidel(big);
+        if(sol.is_feasible() != ref.is_feasible() || (ref.is_feasible() && ref.is_bounded() && sol.get_objective() != ref.get_objective())){
+            cerr << "[ERROR] Presolved lp has a different optimum\n";
+            return;
+        }
+        // the certificates refer to the original rows, with all rows doubled they have to be rescaled
+        vector<vector<Num> > A_doubled = A;
+        for(auto &row:A_doubled) for(auto &e:row) e *= Num(2);
+        Lp_Instance doubled(A_doubled, lp.get_c());
+        // cut off the optimum to get an infeasible lp
+        A_doubled.push_back(lp.get_c());
+        for(auto &e:A_doubled.back()) e *= Num(-2);
+        A_doubled.back().push_back(Num(2000000000) * Num(1000000000) * Num(1000000000));
+        Lp_Instance cut_off(A_doubled, lp.get_c());
+        Lp_Result mapped = solve_presolved(big, solve_seidel, true), infeasible = solve_presolved(cut_off, solve_seidel);
+        if(!verify_result(big, mapped) || !verify_result(doubled, solve_presolved(doubled, solve_seidel)) || infeasible.is_feasible() || !verify_result(cut_off, infeasible)){
+            cerr << "[ERROR] Invalid certificate of presolved lp\n";
+            return;
+        }
+        cerr << "    Test Passed.\n\n";
+    }
+
+    void test_certificates_from_file(string filename, Solver solver){
+        reset_seed();
+        cerr << "Certificate test  file=" << filename << ", solver=" << (uintptr_t)solver << "\n";
+        Lp_Instance lp = read_lp_file(filename);
+        if(!verify_result(lp, solver(lp))){
+            cerr << "[ERROR] Invalid dual certificate\n";
+            return;
+        }
+        // cut off the optimum to get an infeasible lp
+        vector<vector<Num> > A = lp.get_A();
+        A.emplace_back(lp.get_c());
+        for(auto &e:A.back()) e = -e;
+        A.back().push_back(Num(1000000000) * Num(1000000000) * Num(1000000000));
+        Lp_Instance infeasible(A, lp.get_c());
+        Lp_Result sol = solver(infeasible);
+        if(sol.is_feasible() || !verify_result(infeasible, sol)){
+            cerr << "[ERROR] Invalid farkas certificate\n";
+            return;
+        }
+        cerr << "    Test Passed.\n\n";
+    }
+
+    void test_binary_from_file(string filename, Solver solver){
+        reset_seed();
+        cerr << "Binary format test  file=" << filename << "\n";
+        Lp_Instance lp = read_lp_file(filename);
+        // make some coefficients larger than a word
+        vector<vector<Num> > A = lp.get_A();
+        for(size_t i=0;i<A.size();i+=7) A[i].back() *= Num(1000000000) * Num(1000000000) * Num(1000000000);
+        lp.set_A(A);
+        ostringstream lp_out;
+        execute_timed("Write", [&](){ write_binary(lp_out, lp); });
+        const string lp_data = lp_out.str();
+        Binary_Lp_View view(lp_data.data(), lp_data.data() + lp_data.size());
+        if(view.n() != lp.n() || view.d() != lp.d() || view.objective() != lp.get_c()){
+            cerr << "[ERROR] Binary lp has a different size or objective\n";
+            return;
+        }
+        for(int i=0;i<lp.n();++i){
+            if(view.row(i) != A[i]){
+                cerr << "[ERROR] Binary lp differs in row " << i << "\n";
+                return;
+            }
+        }
+        for(int j=0;j<=lp.d();++j){
+            size_t bits = 0;
+            for(auto const&e:A) bits = max(bits, e[j].bitlength());
+            if(view.column_bits(j) != bits){
+                cerr << "[ERROR] Wrong bitlength for column " << j << "\n";
+                return;
+            }
+        }
+        // offset tables out of order or past the end are rejected when the view is opened
+        const size_t offset_pos = (32 + 4*(lp.d()+2) + 7) / 8 * 8;
+        for(int corruption=0;corruption<2;++corruption){
+            string bad = lp_data;
+            if(corruption == 0) std::swap_ranges(&bad[offset_pos + 8], &bad[offset_pos + 16], &bad[offset_pos + 16]);
+            else bad[offset_pos + 8*lp.n() + 7] = char(0x7f);
+            bool rejected = false;
+            try {
+                Binary_Lp_View bad_view(bad.data(), bad.data() + bad.size());
+            } catch(std::runtime_error const&){
+                rejected = true;
+            }
+            if(!rejected){
+                cerr << "[ERROR] Corrupted offset table " << corruption << " accepted\n";
+                return;
+            }
+        }
+        Lp_Result sol = solver(execute_timed("Load", [&view](){ return view.to_instance(); }));
+        ostringstream sol_out;
+        write_binary(sol_out, sol);
+        const string sol_data = sol_out.str();
+        Lp_Result loaded = read_binary_result(sol_data.data(), sol_data.data() + sol_data.size());
+        if(loaded.get_status() != sol.get_status() || loaded.get_x() != sol.get_x() || loaded.get_ray() != sol.get_ray()
+            || loaded.get_objective() != sol.get_objective() || loaded.get_basis() != sol.get_basis()
+            || loaded.get_dual() != sol.get_dual() || loaded.get_farkas() != sol.get_farkas()){
+            cerr << "[ERROR] Lp result changed in binary round trip\n";
+            return;
+        }
+        cerr << "    Test Passed.\n\n";
+    }
+
+    void test_streaming_from_file(string filename){
+        reset_seed();
+        cerr << "Streaming test  file=" << filename << "\n";
+        // a sign without digits and sizes out of range are errors, not 0 or wrapped around
+        for(string bad : {"- 2 1 1", "2 - 5 7", "99999999999999999999 2", "3000000000 2"}){
+            Lp_Reader reader(bad.data(), bad.data() + bad.size());
+            bool rejected = false;
+            try {
+                reader.read_instance();
+            } catch(std::runtime_error const&){
+                rejected = true;
+            }
+            if(!rejected){
+                cerr << "[ERROR] Invalid lp size " << bad << " accepted\n";
+                return;
+            }
+        }
+        Text_Lp_Source source(filename);
+        Lp_Result sol = execute_timed("Streaming", [&source](){ return solve_clarkson_streaming(source, solve_seidel<false>); });
+        Lp_Instance lp = read_lp_file(filename);
+        if(!verify_result(lp, sol)){
+            cerr << "[ERROR] Invalid streaming result\n";
+            return;
+        }
+        Lp_Result ref = solve_clarkson_seidel(lp);
+        if(sol.get_status() != ref.get_status() || (ref.is_feasible() && ref.is_bounded() && sol.get_objective() != ref.get_objective())){
+            cerr << "[ERROR] Streaming result differs\n";
+            return;
+        }
+        cerr << "    Test Passed.\n\n";
+    }
+
+    void test_clarkson_policy_from_file(string filename){
+        reset_seed();
+        cerr << "Clarkson policy test  file=" << filename << "\n";
+        Lp_Instance lp = read_lp_file(filename);
+        Lp_Result ref = solve_clarkson_seidel(lp);
+        Clarkson_Policy policy;
+        policy.adaptive = true;
+        policy.sample_2 = 0.5;
+        Clarkson_Stats stats;
+        Lp_Result sol = execute_timed("Adaptive", [&](){ return solve_clarkson(lp, solve_seidel<false>, policy, &stats); });
+        cerr << stats;
+        if(sol.get_status() != ref.get_status() || (ref.is_feasible() && ref.is_bounded() && sol.get_objective() != ref.get_objective())){
+            cerr << "[ERROR] Adaptive clarkson result differs\n";
+            return;
+        }
+        int64_t rounds = 0;
+        for(auto const&e:stats.violators) rounds += e;
+        if(stats.iterations_2 == 0 || rounds != stats.iterations_2 || stats.iterations_1 < stats.iterations_2){
+            cerr << "[ERROR] Inconsistent clarkson telemetry\n";
+            return;
+        }
+        cerr << "    Test Passed.\n\n";
+    }
+
+    void test_profile_from_file(string filename){
+        reset_seed();
+        cerr << "Profile test  file=" << filename << "\n";
+        Lp_Instance lp = read_lp_file(filename);
+        reset_profile();
+        solve_clarkson(lp, solve_simplex);
+        Profile p = get_profile();
+        #ifdef DACIN_LP_PROFILE
+        cerr << p;
+        write_profile_json(cerr, p);
+        cerr << "\n";
+        if(!p.event_count[int(Solver_Event::SIMPLEX_PIVOT)] || !p.event_count[int(Solver_Event::CLARKSON_1_ITERATION)] || p.scanned_rows < (uint64_t)lp.n()){
+            cerr << "[ERROR] Missing profile counters\n";
+            return;
+        }
+        #else
+        if(p.event_count[int(Solver_Event::SIMPLEX_PIVOT)] || p.scanned_rows){
+            cerr << "[ERROR] Profile counters without DACIN_LP_PROFILE\n";
+            return;
+        }
+        #endif
+        cerr << "    Test Passed.\n\n";
+    }
+
+    void test_number_type_from_file(string filename){
+        reset_seed();
+        cerr << "Number type test  file=" << filename << "\n";
+        // fixed width arithmetic agrees with Num and reports overflow
+        for(const char *s : {"0", "7", "-7", "123456789012345678901234567890", "-57896044618658097711785492504343953926634992332820282019728792003956564819968"}){
+            Num a(s);
+            for(int b : {1, -1, 3, -10, 1000000007}){
+                if(b == -1 && a.bitlength() == 256) continue; // the quotient overflows
+                if(convert_number<Num>(Int256(s) / Int256(b)) != a / Num(b) || convert_number<Num>(Int256(s) % Int256(b)) != a % Num(b)){
+                    cerr << "[ERROR] Int256 division of " << s << " by " << b << "\n";
+                    return;
+                }
+            }
+        }
+        // karatsuba sized products agree with schoolbook multiplication for all signs
+        {
+            auto random_num = [](int n){
+                vector<Num::word> words(n);
+                for(auto &e:words) e = Num::word(rng()) << 32 | rng();
+                return Num(words.data(), words.data() + n);
+            };
+            const Num a = random_num(70), b = random_num(50);
+            const size_t threshold = Num::karatsuba_threshold();
+            for(int signs=0;signs<4;++signs){
+                const Num x = signs & 1 ? -a : a, y = signs & 2 ? -b : b;
+                Num::karatsuba_threshold() = 1;
+                const Num fast = x * y;
+                Num::karatsuba_threshold() = std::numeric_limits<size_t>::max();
+                const Num slow = x * y;
+                Num::karatsuba_threshold() = threshold;
+                if(fast != slow){
+                    cerr << "[ERROR] Karatsuba product with signs " << signs << "\n";
+                    return;
+                }
+            }
+            // addmul_long with opposite signs, the product has as many words as out, which is also an operand
+            for(int signs=0;signs<4;++signs){
+                Num x = signs & 1 ? -a : a, y = Num(signs & 2 ? -1 : 1);
+                const Num expected = x + x * y;
+                Num::addmul_long(x, x, y);
+                Num z = signs & 1 ? -a : a;
+                Num::addmul_long(z, y, z);
+                if(x != expected || z != expected){
+                    cerr << "[ERROR] addmul_long with signs " << signs << "\n";
+                    return;
+                }
+            }
+        }
+        bool overflow = false;
+        try {
+            Int64 x(1 << 30);
+            for(int i=0;i<3;++i) x *= x;
+        } catch(std::overflow_error const&){
+            overflow = true;
+        }
+        if(!overflow){
+            cerr << "[ERROR] Missing Int64 overflow\n";
+            return;
+        }
+        Lp_Instance lp = read_lp_file(filename);
+        Lp_Result ref = solve_clarkson_seidel(lp);
+        // the coefficients of seidel grow faster than those of the fraction free simplex
+        Basic_Lp_Result<Int128> sol_128 = execute_timed("Int128", [&lp](){ return solve_clarkson_simplex<Int128>(convert_lp<Int128>(lp)); });
+        Basic_Lp_Result<Int256> sol_256 = execute_timed("Int256", [&lp](){ return solve_clarkson_seidel<false, Int256>(convert_lp<Int256>(lp)); });
+        for(Lp_Result const&sol : {convert_result<Num>(sol_128), convert_result<Num>(sol_256)}){
+            if(!verify_result(lp, sol) || sol.get_status() != ref.get_status() || sol.get_objective() != ref.get_objective()){
+                cerr << "[ERROR] Fixed width result differs\n";
+                return;
+            }
+        }
+        cerr << "    Test Passed.\n\n";
+    }
+
+    void test_fixed_width_from_file(string filename){
+        reset_seed();
+        cerr << "Fixed width test  file=" << filename << "\n";
+        // 0 <= x, y <= 1000, x + 2y <= 1500, maximize 3x + 4y
+        Lp_Instance small({{-1, 0, 0}, {0, -1, 0}, {1, 0, -1000}, {0, 1, -1000}, {1, 2, -1500}}, {3, 4});
+        if(narrowest_type(analyze_width(small).seidel_bits) != Int_Type::INT64){
+            cerr << "[ERROR] Unexpected width of the small lp\n";
+            return;
+        }
+        if(solve_clarkson_seidel_fixed_width(small, false).get_objective() != Fraction(Num(4000))){
+            cerr << "[ERROR] Wrong objective of the small lp\n";
+            return;
+        }
+        Lp_Instance lp = read_lp_file(filename);
+        const Width_Bounds bounds = analyze_width(lp);
+        cerr << "input " << bounds.input_bits << " bits, seidel " << bounds.seidel_bits << " bits, simplex " << bounds.simplex_bits << " bits\n";
+        Lp_Result ref = solve_clarkson_seidel(lp);
+        for(bool speculative : {false, true}){
+            for(Lp_Result const&sol : {solve_clarkson_seidel_fixed_width(lp, speculative), solve_clarkson_simplex_fixed_width(lp, speculative)}){
+                if(!verify_result(lp, sol) || sol.get_status() != ref.get_status() || sol.get_objective() != ref.get_objective()){
+                    cerr << "[ERROR] Fixed width result differs\n";
+                    return;
+                }
+            }
+        }
+        cerr << "    Test Passed.\n\n";
+    }
+
+    void test_modular_from_file(string filename){
+        reset_seed();
+        cerr << "Modular test  file=" << filename << "\n";
+        Lp_Instance lp = read_lp_file(filename);
+        Lp_Result ref = solve_clarkson_seidel(lp);
+        for(int threads : {1, 3}){
+            Lp_Result sol = execute_timed("Modular", solve_basis_modular, lp, ref.get_basis(), threads);
+            string error;
+            if(!verify_result(lp, sol, &error)){
+                cerr << "[ERROR] Invalid modular result: " << error << "\n";
+                return;
+            }
+            if(sol.get_objective() != ref.get_objective() || reduced(sol.get_x()) != reduced(ref.get_x())){
+                cerr << "[ERROR] Modular result differs\n";
+                return;
+            }
+        }
+        // two equal rows make the basis singular
+        vector<int> singular = ref.get_basis();
+        singular[1] = singular[0];
+        if(solve_basis_modular(lp, singular).get_status() != Lp_Status::ERROR){
+            cerr << "[ERROR] Singular basis not detected\n";
+            return;
+        }
+        cerr << "    Test Passed.\n\n";
+    }
+
+    void test_fraction_from_file(string filename){
+        reset_seed();
+        cerr << "Fraction test  file=" << filename << "\n";
+        // random fractions of mixed sizes, pairs are close to each other to reach the exact comparison
+        auto random_num = [](size_t words){
+            Num ret(words, 0, rng()%2);
+            for(auto &e:ret.words) e = (uint64_t(rng()) << 32) | rng();
+            if(words) ret[words-1] |= 1;
+            return ret;
+        };
+        for(int it=0;it<1000;++it){
+            const size_t words = it%20;
+            Num p = random_num(words), q = Num::abs(random_num(words)) + Num(1);
+            Num r = p + Num(int(rng()%3) - 1), s = q;
+            if(it%3 == 0){
+                r *= Num(3);
+                s *= Num(3);
+            }
+            Fraction x(p, q), y(r, s);
+            const int expected = Num::cmp(p * s, q * r);
+            if(x.cmp(y) != expected || y.cmp(x) != -expected){
+                cerr << "[ERROR] Fraction comparison of " << x << " and " << y << "\n";
+                return;
+            }
+            Fraction diff = x - y, sum = x + y;
+            if(Num::cmp(diff.numerator() * q * s, diff.denominator() * (p * s - r * q)) != 0 || sum - y != x || diff.cmp(Fraction()) != expected){
+                cerr << "[ERROR] Fraction arithmetic of " << x << " and " << y << "\n";
+                return;
+            }
+            sum.normalize();
+            if(Num::gcd(Num::abs(sum.numerator()), sum.denominator()) != Num(1) && sum.numerator().sign() != 0){
+                cerr << "[ERROR] Fraction not normalized " << sum << "\n";
+                return;
+            }
+        }
+        if(!(-Fraction::inf() < Fraction(Num(-5)) && Fraction(Num(5)) < Fraction::inf() && Fraction::inf() == Fraction::inf())){
+            cerr << "[ERROR] Fraction infinity comparison\n";
+            return;
+        }
+        Lp_Instance lp = read_lp_file(filename);
+        Lp_Result ref = solve_clarkson_seidel(lp);
+        Lp_Result sol = execute_timed("Simplex", solve_clarkson_simplex<Num>, lp);
+        if(!verify_result(lp, sol) || sol.get_objective() != ref.get_objective()){
+            cerr << "[ERROR] Simplex result differs\n";
+            return;
+        }
+        cerr << "    Test Passed.\n\n";
+    }
+
+    void test_ratio_test_from_file(string filename){
+        reset_seed();
+        cerr << "Ratio test  file=" << filename << "\n";
+        // the kernels of the simplex agree with cross-multiplication, also for close and equal values
+        for(int it=0;it<1000;++it){
+            Num t = -Num(int(rng()%1000) + 1), n = Num(int(rng()%1000) + 1);
+            for(int k=it%40;k>0;--k){
+                t *= Num(int(rng()%1000000) + 1);
+                n *= Num(int(rng()%1000000) + 1);
+            }
+            const Num f(int(rng()%3) + 1);
+            const Num u = t * f + Num(int(rng()%3) - 1), m = n * f * f;
+            const int expected = Num::cmp(u * u * n, t * t * m);
+            if(detail::cmp_slope(t, n, u, m) != expected || detail::cmp_slope(u, m, t, n) != -expected){
+                cerr << "[ERROR] Slope comparison of " << t << "^2/" << n << " and " << u << "^2/" << m << "\n";
+                return;
+            }
+            if(detail::cmp_fraction(t, n, u, m) != Num::cmp(t * m, n * u)){
+                cerr << "[ERROR] Ratio comparison of " << t << "/" << n << " and " << u << "/" << m << "\n";
+                return;
+            }
+        }
+        Lp_Instance lp = read_lp_file(filename);
+        Lp_Result ref = solve_clarkson_seidel(lp);
+        Lp_Result sol = execute_timed("Simplex", solve_simplex<Num>, lp);
+        if(!verify_result(lp, sol) || sol.get_objective() != ref.get_objective()){
+            cerr << "[ERROR] Simplex result differs\n";
+            return;
+        }
+        cerr << "    Test Passed.\n\n";
+    }
+
+    void test_bounded_simplex_from_file(string filename){
+        reset_seed();
+        cerr << "Bounded simplex test  file=" << filename << "\n";
+        auto check = [](Lp_Instance const&lp, string const&name){
+            Lp_Result ref = solve_simplex(lp);
+            Lp_Result sol = solve_bounded_simplex(lp);
+            string error;
+            if(!verify_result(lp, sol, &error)){
+                cerr << "[ERROR] Invalid bounded simplex result on " << name << ": " << error << "\n";
+                return false;
+            }
+            if(sol.get_status() != ref.get_status() || sol.get_objective() != ref.get_objective()){
+                cerr << "[ERROR] Bounded simplex result differs on " << name << "\n";
+                return false;
+            }
+            return true;
+        };
+        // the lps of the file have no bound rows, so all variables are free
+        Lp_Instance lp = read_lp_file(filename);
+        Lp_Result ref = solve_clarkson_seidel(lp);
+        Lp_Result sol = execute_timed("Bounded simplex", solve_bounded_simplex<Num>, lp);
+        if(!verify_result(lp, sol) || sol.get_objective() != ref.get_objective()){
+            cerr << "[ERROR] Bounded simplex result differs\n";
+            return;
+        }
+        if(!check(generate_random(40, 5, 3, 1), "box") || !check(generate_degenerate(30, 4, 2), "degenerate") || !check(generate_prefix_sum(20, 4, 3), "prefix sum")){
+            return;
+        }
+        // random rows and rational bounds, some of them redundant, contradicting or missing
+        auto small = [](){ return Num(uniform_int_distribution<int>(-5, 5)(rng)); };
+        for(int it=0;it<300;++it){
+            const int d = 1 + it%4, n = it%5;
+            vector<vector<Num> > A;
+            for(int i=0;i<n;++i){
+                A.emplace_back(d+1);
+                for(auto &e:A.back()) e = small();
+            }
+            for(int j=0;j<d;++j){
+                for(int k=uniform_int_distribution<int>(0, 3)(rng);k>0;--k){
+                    A.emplace_back(d+1);
+                    A.back()[j] = Num(uniform_int_distribution<int>(1, 4)(rng) * (rng()%2 ? 1 : -1));
+                    A.back()[d] = small();
+                }
+            }
+            vector<Num> c(d);
+            for(auto &e:c) e = small();
+            if(!check(Lp_Instance(move(A), move(c)), "random lp " + std::to_string(it))) return;
+        }
+        cerr << "    Test Passed.\n\n";
+    }
+
+    void test_degeneracy_from_file(string filename){
+        reset_seed();
+        cerr << "Degeneracy test  file=" << filename << "\n";
+        const size_t limit = simplex_stall_limit();
+        auto check = [&](Lp_Instance const&lp, string const&name){
+            Lp_Result ref = solve_clarkson_seidel(lp);
+            // bland's rule from the first pivot on and the default
+            for(size_t stall_limit : {size_t(0), limit}){
+                simplex_stall_limit() = stall_limit;
+                simplex_stats() = Simplex_Stats();
+                Lp_Result sol = solve_simplex(lp), bounded = solve_bounded_simplex(lp);
+                Simplex_Stats stats = simplex_stats();
+                simplex_stall_limit() = limit;
+                if(!verify_result(lp, sol) || !verify_result(lp, bounded) || sol.get_objective() != ref.get_objective() || bounded.get_objective() != ref.get_objective()){
+                    cerr << "[ERROR] Simplex result differs on " << name << " with stall limit " << stall_limit << "\n";
+                    return false;
+                }
+                if(stats.degenerate_pivots > stats.pivots || (stall_limit == 0 && stats.bland_pivots != stats.pivots)){
+                    cerr << "[ERROR] Wrong pivot counts on " << name << "\n";
+                    return false;
+                }
+            }
+            return true;
+        };
+        if(!check(read_lp_file(filename), filename) || !check(generate_degenerate(100, 6, 4), "degenerate")){
+            return;
+        }
+        simplex_stats() = Simplex_Stats();
+        solve_simplex(generate_degenerate(100, 6, 4));
+        if(simplex_stats().degenerate_pivots == 0){
+            cerr << "[ERROR] Degenerate pivots not counted\n";
+            return;
+        }
+        cerr << "    Test Passed.\n\n";
+    }
+
+    void test_interior_point_from_file(string filename){
+        reset_seed();
+        cerr << "Interior point test  file=" << filename << "\n";
+        auto check = [&](Lp_Instance const&lp, string const&name, bool expect_certified){
+            Interior_Point_Stats stats;
+            Lp_Result sol = solve_interior_point(lp, Interior_Point_Options(), &stats);
+            Lp_Result ref = solve_bounded_simplex(lp);
+            if(!verify_result(lp, sol) || sol.get_status() != ref.get_status() || sol.get_objective() != ref.get_objective()){
+                cerr << "[ERROR] Interior point result differs on " << name << "\n";
+                return false;
+            }
+            if(expect_certified && (!stats.converged || !stats.certified)){
+                cerr << "[ERROR] Interior point crossover failed on " << name << "\n";
+                return false;
+            }
+            return true;
+        };
+        if(!check(read_lp_file(filename), filename, true) || !check(generate_random(200, 10, 10, 1), "dense", true)
+           || !check(generate_random(200, 10, 2, 2), "sparse", false) || !check(generate_degenerate(100, 6, 4), "degenerate", false)){
+            return;
+        }
+        cerr << "    Test Passed.\n\n";
+    }
+
+    void test_portfolio_from_file(string filename){
+        reset_seed();
+        cerr << "Portfolio test  file=" << filename << "\n";
+        const Lp_Instance lp = read_lp_file(filename);
+        const Lp_Result ref = solve_clarkson_seidel(lp);
+        for(Solver_Type solver : {Solver_Type::SEIDEL, Solver_Type::CLARKSON_SEIDEL, Solver_Type::CLARKSON_SIMPLEX, Solver_Type::SIMPLEX, Solver_Type::BOUNDED_SIMPLEX, Solver_Type::INTERIOR_POINT}){
+            Lp_Result res = solve_with(solver, lp);
+            if(!verify_result(lp, res) || res.get_objective() != ref.get_objective()){
+                cerr << "[ERROR] " << solver_name(solver) << " differs\n";
+                return;
+            }
+        }
+        for(Lp_Instance const&gen_lp : {generate_degenerate(200, 6, 3), generate_prefix_sum(1000, 3, 2), generate_random(200, 10, 10, 5)}){
+            Solver_Type chosen;
+            Lp_Result res = solve_auto(gen_lp, &chosen);
+            Lp_Result exact = solve_with(choose_solver(analyze_shape(gen_lp), false), gen_lp);
+            if(!verify_result(gen_lp, res) || res.get_objective() != exact.get_objective()){
+                cerr << "[ERROR] solve_auto with " << solver_name(chosen) << " differs\n";
+                return;
+            }
+        }
+        // seidel and the simplex don't scale to large d and large n respectively
+        Lp_Shape shape;
+        shape.n = 100000;
+        shape.d = 20;
+        const Solver_Type high_d = choose_solver(shape);
+        shape.d = 2;
+        const Solver_Type large_n = choose_solver(shape, false);
+        if(high_d != Solver_Type::INTERIOR_POINT || large_n == Solver_Type::SIMPLEX || large_n == Solver_Type::BOUNDED_SIMPLEX){
+            cerr << "[ERROR] Wrong choice " << solver_name(high_d) << ", " << solver_name(large_n) << "\n";
+            return;
+        }
+        cerr << "    Test Passed.\n\n";
+    }
+
+    void test_solve_context_from_file(string filename){
+        reset_seed();
+        cerr << "Solve context test  file=" << filename << "\n";
+        const Lp_Instance lp = read_lp_file(filename);
+        const Lp_Result ref = solve_clarkson_seidel(lp);
+        const double opt = ref.get_objective().numerator().to_double() / ref.get_objective().denominator().to_double();
+        const double eps = 1e-9 * (1 + std::abs(opt));
+        auto simplex = [](Lp_Instance const&lp_){ return solve_simplex(lp_); };
+        auto clarkson_simplex = [](Lp_Instance const&lp_){ return solve_clarkson_simplex(lp_); };
+        {
+            Solve_Context context;
+            Lp_Result res = solve_with_context(context, lp, clarkson_simplex);
+            if(!verify_result(lp, res) || res.get_objective() != ref.get_objective()){
+                cerr << "[ERROR] Result with context differs\n";
+                return;
+            }
+        }
+        {
+            Solve_Context cancelled, expired;
+            cancelled.cancel();
+            expired.set_timeout(0);
+            if(solve_with_context(cancelled, lp, simplex).get_status() != Lp_Status::CANCELLED || cancelled.is_timed_out()
+                    || solve_with_context(expired, lp, simplex).get_status() != Lp_Status::CANCELLED || !expired.is_timed_out()){
+                cerr << "[ERROR] Solve not cancelled\n";
+                return;
+            }
+        }
+        // the simplex reports feasible vertices, clarkson the optima of its samples
+        for(bool use_clarkson : {false, true}){
+            Solve_Context context;
+            int calls = 0;
+            Solve_Progress last;
+            context.set_progress_callback([&](Solve_Progress const&progress){ ++calls; last = progress; }, 0);
+            Lp_Result res = solve_with_context(context, lp, use_clarkson ? clarkson_simplex : simplex);
+            Solve_Progress const&progress = context.get_progress();
+            const uint64_t pivots = progress.events[int(Solver_Event::SIMPLEX_PIVOT)], rounds = progress.events[int(Solver_Event::CLARKSON_2_ITERATION)];
+            const bool bounds_ok = use_clarkson ? progress.lower_bound == -INFINITY && progress.upper_bound >= opt - eps
+                                                : progress.lower_bound <= opt + eps && progress.lower_bound > -INFINITY && progress.upper_bound == INFINITY;
+            if(res.get_objective() != ref.get_objective() || calls == 0 || !pivots || bool(rounds) != use_clarkson || !bounds_ok
+                    || last.events[int(Solver_Event::SIMPLEX_PIVOT)] > pivots){
+                cerr << "[ERROR] Wrong progress " << calls << " " << pivots << " " << rounds << " " << progress.lower_bound << " " << progress.upper_bound << "\n";
+                return;
+            }
+        }
+        {
+            Solve_Context context, cancelled;
+            cancelled.cancel();
+            Lp_Result res = solve_race(context, lp, Solver_Type::SEIDEL, Solver_Type::SIMPLEX);
+            if(!verify_result(lp, res) || res.get_objective() != ref.get_objective()
+                    || solve_race(cancelled, lp, Solver_Type::CLARKSON_SEIDEL, Solver_Type::BOUNDED_SIMPLEX).get_status() != Lp_Status::CANCELLED){
+                cerr << "[ERROR] Race failed\n";
+                return;
+            }
+        }
+        // threads started by the solvers stop with the context too
+        {
+            Solve_Context cancelled;
+            cancelled.cancel();
+            vector<Lp_Result> results = solve_clarkson_batch(lp, {lp.get_c(), lp.get_c()}, solve_seidel<false>, 2, &cancelled);
+            for(auto const&e:solve_parallel(vector<Lp_Instance>{lp, lp}, clarkson_simplex, 2, 0, &cancelled)) results.push_back(e);
+            results.push_back(solve_with_context(cancelled, lp, [&ref](Lp_Instance const&lp_){ return solve_basis_modular(lp_, ref.get_basis(), 2); }));
+            for(auto const&e:results){
+                if(e.get_status() != Lp_Status::CANCELLED){
+                    cerr << "[ERROR] Threads of a cancelled solve not cancelled\n";
+                    return;
+                }
+            }
+        }
+        // the workers of a seeded batch take their random states from the seed, a rerun finds the same bases
+        {
+            const Lp_Instance degenerate = generate_degenerate(200, 4, 7);
+            vector<vector<Num> > objectives(6, degenerate.get_c());
+            vector<vector<int> > bases;
+            for(int k=0;k<2;++k){
+                Solve_Context context;
+                context.set_seed(17);
+                vector<Lp_Result> results;
+                solve_with_context(context, degenerate, [&](Lp_Instance const&lp_){
+                    results = solve_clarkson_batch(lp_, objectives, solve_seidel<false>, 3);
+                    return results.back();
+                });
+                for(auto const&e:results) bases.push_back(e.get_basis());
+            }
+            if(!std::equal(bases.begin(), bases.begin() + objectives.size(), bases.begin() + objectives.size())){
+                cerr << "[ERROR] Seeded batch not reproducible\n";
+                return;
+            }
+        }
+        cerr << "    Test Passed.\n\n";
+    }
+
+    void test_parallel_from_file(string filename, int objectives, int threads){
+        reset_seed();
+        cerr << "Parallel test  file=" << filename << ", objectives=" << objectives << ", threads=" << threads << "\n";
+        Lp_Instance lp = read_lp_file(filename);
+        vector<Lp_Instance> lps;
+        for(int i=0;i<objectives;++i){
+            vector<Num> c(lp.d());
+            for(auto &f:c) f = Num(uniform_int_distribution<int>(-100, 100)(rng));
+            lps.emplace_back(lp.get_A(), move(c));
+            // many optimal bases, so the basis found depends on the random choices
+            lps.push_back(generate_degenerate(200, 4, i));
+        }
+        auto solve = [](Lp_Instance const&lp_){ return solve_clarkson_seidel(lp_); };
+        const std::mt19937 before = rng;
+        auto sols = execute_timed("Parallel", [&](){ return solve_parallel(lps, solve, threads, 42); });
+        auto sequential = solve_parallel(lps, solve, 1, 42);
+        if(rng != before){
+            cerr << "[ERROR] Seeded solves changed the thread rng\n";
+            return;
+        }
+        for(size_t i=0;i<lps.size();++i){
+            if(!verify_result(lps[i], sols[i]) || sols[i].get_objective() != solve(lps[i]).get_objective()){
+                cerr << "[ERROR] Parallel result differs for lp " << i << "\n";
+                return;
+            }
+            if(sols[i].get_x() != sequential[i].get_x() || sols[i].get_basis() != sequential[i].get_basis()){
+                cerr << "[ERROR] Parallel result depends on the number of threads for lp " << i << "\n";
+                return;
+            }
+        }
+        cerr << "    Test Passed.\n\n";
+    }
+
     void run_tests(){
+        test_parallel_from_file("examples/enclosing_annulus_2_1000.lp", 50, 4);
+        test_solve_context_from_file("examples/enclosing_annulus_2_1000.lp");
+        test_portfolio_from_file("examples/enclosing_annulus_2_1000.lp");
+        test_interior_point_from_file("examples/enclosing_annulus_2_1000.lp");
+        test_degeneracy_from_file("examples/enclosing_annulus_spherical_2_1000.lp");
+        test_bounded_simplex_from_file("examples/enclosing_annulus_2_1000.lp");
+        test_ratio_test_from_file("examples/enclosing_annulus_spherical_3_1000.lp");
+        test_fraction_from_file("examples/enclosing_annulus_2_1000.lp");
+        test_modular_from_file("examples/enclosing_annulus_spherical_3_1000.lp");
+        test_fixed_width_from_file("examples/enclosing_annulus_2_1000.lp");
+        test_number_type_from_file("examples/enclosing_annulus_2_1000.lp");
+        test_profile_from_file("examples/enclosing_annulus_2_1000.lp");
+        test_clarkson_policy_from_file("examples/enclosing_annulus_3_10000.lp");
+        test_streaming_from_file("examples/enclosing_annulus_spherical_3_10000.lp");
+        test_binary_from_file("examples/enclosing_annulus_3_1000.lp", [](Lp_Instance lp){return solve_clarkson(move(lp), solve_seidel);});
+        test_certificates_from_file("examples/enclosing_annulus_spherical_3_50.lp", solve_simplex);
+        test_certificates_from_file("examples/enclosing_annulus_spherical_3_50.lp", solve_seidel);
+        test_certificates_from_file("examples/enclosing_annulus_3_1000.lp", [](Lp_Instance lp){return solve_clarkson(move(lp), solve_seidel);});
+        test_presolve_from_file("examples/enclosing_annulus_2_1000.lp");
+        test_incremental_from_file("examples/enclosing_annulus_2_1000.lp");
+        test_batch_from_file("examples/enclosing_annulus_2_1000.lp", 16, 4);
         //run_tests_annulus(solve_seidel);
         run_tests_annulus([](Lp_Instance lp){return solve_clarkson(move(lp), solve_seidel);});
         run_tests_annulus([](Lp_Instance lp){return solve_clarkson(move(lp), solve_seidel<true>);});
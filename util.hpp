@@ -8,11 +8,12 @@ namespace dacin{ namespace lp{
     using std::vector;
     using std::move;
 
+    // thread_local so that independent solves may run on separate threads
     #ifdef LOCAL_RUN
     constexpr int seed = 918273741;
-    std::mt19937 rng(918273741);
+    thread_local std::mt19937 rng(918273741);
     #else
-    std::mt19937 rng(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now().time_since_epoch()).count());
+    thread_local std::mt19937 rng(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now().time_since_epoch()).count());
     #endif // LOCAL_run
     void reset_seed(){
         #ifdef LOCAL_RUN
@@ -20,30 +21,66 @@ namespace dacin{ namespace lp{
         #endif
     }
 
-    Num scal_affine(vector<Num> const&a, vector<Num> const&b){
+    template<typename Int>
+    Int scal_affine(vector<Int> const&a, vector<Int> const&b){
         size_t n = std::min(a.size(), b.size());
         assert(a.size() <= n+1 && b.size() <= n+1);
-        Num ret(0);
+        Int ret(0);
         for(size_t i=0; i<n; ++i){
             ret += a[i]*b[i];
         }
         return ret;
     }
-    Num scal(vector<Num> const&a, vector<Num> const&b){
+    template<typename Int>
+    Int scal(vector<Int> const&a, vector<Int> const&b){
         assert(a.size() == b.size());
         return scal_affine(a, b);
     }
-    void reduce_by_gcd(vector<Num> &v){
-        Num g(0);
+    template<typename Int>
+    vector<double> to_doubles(vector<Int> const&v){
+        vector<double> ret(v.size());
+        for(size_t i=0;i<v.size();++i){
+            ret[i] = v[i].to_double();
+        }
+        return ret;
+    }
+    /*
+     * sign of scal_affine(a, b), where b_d == to_doubles(b) is converted once and shared by many calls.
+     * A floating point estimate decides the sign if it is far enough from 0,
+     * otherwise (or on overflow) the exact product is computed.
+     */
+    template<typename Int>
+    int filtered_sign_scal(vector<Int> const&a, vector<Int> const&b, vector<double> const&b_d){
+        const size_t n = std::min(a.size(), b.size());
+        double sum = 0, abs_sum = 0;
+        size_t words = 0;
+        for(size_t i=0;i<n;++i){
+            const double p = a[i].to_double() * b_d[i];
+            sum += p;
+            abs_sum += std::fabs(p);
+            words = std::max(words, std::max(a[i].size(), b[i].size()));
+        }
+        // conversion error of both factors and rounding error of the sum
+        const double err = (2*words + n + 2) * std::numeric_limits<double>::epsilon() * abs_sum;
+        if(std::isfinite(abs_sum) && std::fabs(sum) > err){
+            return sum > 0 ? 1 : -1;
+        }
+        return scal_affine(a, b).sign();
+    }
+    template<typename Int>
+    void reduce_by_gcd(vector<Int> &v){
+        Int g(0);
         for(auto &e:v){
-            g = Num::gcd(e%g, g);
+            g = Int::gcd(e%g, g);
         }
-        g.set_neg(false);
+        if(g.sign() == 0) return;
+        g = Int::abs(g);
         for(auto &e:v){
             e /= g;
         }
     }
-    vector<Num> reduced(vector<Num> v){
+    template<typename Int>
+    vector<Int> reduced(vector<Int> v){
         reduce_by_gcd(v);
         return v;
     }
@@ -0,0 +1,99 @@
+#ifndef VERIFY_HPP
+#define VERIFY_HPP
+
+#include <string>
+
+#include "fraction.hpp"
+#include "lp_instance.hpp"
+#include "lp_result.hpp"
+#include "num.hpp"
+#include "util.hpp"
+
+namespace dacin{ namespace lp{
+
+    namespace detail{
+        bool verify_fail(std::string *error, std::string const&message){
+            if(error) *error = message;
+            return false;
+        }
+        // sum_k y[k] * A[basis[k]], or an empty vector if the basis is out of range or some y[k] < 0
+        vector<Num> combine_rows(vector<vector<Num> > const&A, const size_t d1, vector<int> const&basis, vector<Num> const&y){
+            vector<Num> sum(d1);
+            for(size_t k=0;k<basis.size();++k){
+                if(basis[k] < 0 || basis[k] >= (int)A.size() || y[k].sign() < 0) return {};
+                if(y[k].sign() == 0) continue;
+                for(size_t j=0;j<d1;++j){
+                    sum[j] += y[k] * A[basis[k]][j];
+                }
+            }
+            return sum;
+        }
+    }
+
+    /*
+     * Checks the result of a solver against lp in O(n*d) using only exact arithmetic
+     * (feasibility scans go through a floating point filter first):
+     * - optimal:    x is feasible, the dual multipliers are nonnegative, combine to c,
+     *               only use tight constraints and give the same objective
+     * - unbounded:  ray is a feasible direction with c*ray > 0 and x + t*ray is feasible for large t
+     * - infeasible: the farkas multipliers are nonnegative and combine to 0 <= -t with t > 0
+     * On failure, a description is written to error if it is not null.
+     */
+    bool verify_result(Lp_Instance const&lp, Lp_Result const&res, std::string *error = nullptr){
+        using detail::verify_fail;
+        auto const&A = lp.get_A();
+        auto const&c = lp.get_c();
+        const int d = lp.d();
+        auto const&basis = res.get_basis();
+        if(!res.is_feasible()){
+            auto const&y = res.get_farkas();
+            if(y.size() != basis.size() || basis.empty()) return verify_fail(error, "missing farkas certificate");
+            vector<Num> sum = detail::combine_rows(A, d+1, basis, y);
+            if(sum.empty()) return verify_fail(error, "invalid farkas multipliers");
+            for(int j=0;j<d;++j){
+                if(sum[j].sign() != 0) return verify_fail(error, "farkas combination has nonzero normal");
+            }
+            if(sum[d].sign() <= 0) return verify_fail(error, "farkas combination is not a contradiction");
+            return true;
+        }
+        auto const&x = res.get_x();
+        if((int)x.size() != d+1 || x.back().sign() <= 0) return verify_fail(error, "invalid solution vector");
+        const vector<double> x_d = to_doubles(x);
+        if(!res.is_bounded()){
+            // x + t*ray has to be feasible for large t
+            auto const&ray = res.get_ray();
+            if((int)ray.size() != d+1 || ray.back().sign() != 0) return verify_fail(error, "invalid ray");
+            if(scal_affine(c, ray).sign() <= 0) return verify_fail(error, "ray does not increase the objective");
+            const vector<double> ray_d = to_doubles(ray);
+            for(auto const&e:A){
+                const int sign = filtered_sign_scal(e, ray, ray_d);
+                if(sign > 0) return verify_fail(error, "ray is not a feasible direction");
+                if(sign == 0 && filtered_sign_scal(e, x, x_d) > 0) return verify_fail(error, "solution is infeasible");
+            }
+            return true;
+        }
+        for(auto const&e:A){
+            if(filtered_sign_scal(e, x, x_d) > 0) return verify_fail(error, "solution is infeasible");
+        }
+        auto const&y = res.get_dual();
+        if(y.size() != basis.size()+1 || y.back().sign() <= 0) return verify_fail(error, "missing dual certificate");
+        vector<Num> sum = detail::combine_rows(A, d+1, basis, y);
+        if(sum.empty()) return verify_fail(error, "invalid dual multipliers");
+        for(int j=0;j<d;++j){
+            if(sum[j] != y.back() * c[j]) return verify_fail(error, "dual multipliers don't combine to the objective");
+        }
+        for(size_t k=0;k<basis.size();++k){
+            if(y[k].sign() != 0 && scal(A[basis[k]], x).sign() != 0){
+                return verify_fail(error, "complementary slackness is violated");
+            }
+        }
+        // c*x/x_d == -sum_d/y_d
+        if(Num::cmp(scal_affine(c, x) * y.back(), -sum[d] * x.back()) != 0) return verify_fail(error, "primal and dual objective differ");
+        if(Fraction(scal_affine(c, x), x.back()) != res.get_objective()){
+            return verify_fail(error, "objective doesn't match the solution");
+        }
+        return true;
+    }
+
+} }
+#endif // VERIFY_HPP